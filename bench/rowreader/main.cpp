@@ -0,0 +1,139 @@
+#include "rowreader.h"
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QVariantList>
+#include <QTextStream>
+
+// Fills an in-memory SQLite table shaped like Products (dates stored as text, as the sqlite
+// backend does) and times decoding every row through RowReader and through value().toX().
+// The best of several passes is reported, so the first pass warming caches doesn't count.
+
+namespace {
+const int kPasses = 5;
+
+struct Totals {
+    qint64 ids = 0;
+    double prices = 0.0;
+    qint64 textChars = 0;
+    qint64 days = 0;
+};
+
+bool fill(QSqlDatabase db, int rows)
+{
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE Products (product_id INTEGER PRIMARY KEY, product_name TEXT, "
+                    "price REAL, category TEXT, quantity INTEGER, updated_at TEXT)")) {
+        QTextStream(stderr) << "Create failed: " << query.lastError().text() << "\n";
+        return false;
+    }
+
+    QVariantList ids, names, prices, categories, quantities, updated;
+    const QDateTime start(QDate(2024, 1, 1), QTime(8, 0));
+    for (int i = 0; i < rows; ++i) {
+        ids << i + 1;
+        names << QString("Product %1").arg(i);
+        prices << 10.0 + i % 1000 / 4.0;
+        categories << QString("Category %1").arg(i % 50);
+        quantities << i % 200;
+        updated << start.addSecs(i * 37).toString("yyyy-MM-dd hh:mm:ss");
+    }
+
+    db.transaction();
+    query.prepare("INSERT INTO Products VALUES (?, ?, ?, ?, ?, ?)");
+    for (const QVariantList &column : {ids, names, prices, categories, quantities, updated}) {
+        query.addBindValue(column);
+    }
+    if (!query.execBatch()) {
+        QTextStream(stderr) << "Insert failed: " << query.lastError().text() << "\n";
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+const char *const kSelect = "SELECT product_id, product_name, price, category, quantity, updated_at FROM Products";
+
+qint64 decodeWithReader(QSqlDatabase db, Totals &totals)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    query.exec(kSelect);
+
+    RowReader rows(query);
+    const int id = rows.column("product_id");
+    const int name = rows.column("product_name");
+    const int price = rows.column("price");
+    const int category = rows.column("category");
+    const int quantity = rows.column("quantity");
+    const int updatedAt = rows.column("updated_at");
+    while (rows.next()) {
+        totals.ids += rows.toInt(id) + rows.toInt(quantity);
+        totals.prices += rows.toDouble(price);
+        totals.textChars += rows.toString(name).size() + rows.toString(category).size();
+        totals.days += rows.toDateTime(updatedAt).date().day();
+    }
+    return timer.nsecsElapsed();
+}
+
+qint64 decodeWithValues(QSqlDatabase db, Totals &totals)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    query.exec(kSelect);
+
+    // Positional, so the difference measured is the conversions rather than field lookups
+    while (query.next()) {
+        totals.ids += query.value(0).toInt() + query.value(4).toInt();
+        totals.prices += query.value(2).toDouble();
+        totals.textChars += query.value(1).toString().size() + query.value(3).toString().size();
+        totals.days += query.value(5).toDateTime().date().day();
+    }
+    return timer.nsecsElapsed();
+}
+
+template <typename Decode>
+void report(QTextStream &out, const char *label, int rows, Decode decode, QSqlDatabase db)
+{
+    qint64 best = -1;
+    Totals totals;
+    for (int pass = 0; pass < kPasses; ++pass) {
+        const qint64 nsecs = decode(db, totals);
+        if (best < 0 || nsecs < best) best = nsecs;
+    }
+    const double ms = best / 1e6;
+    out << label << ": " << QString::number(ms, 'f', 1) << " ms, "
+        << QString::number(rows / (best / 1e9), 'f', 0) << " rows/s"
+        << " (checksum " << totals.ids + totals.textChars + totals.days << ")\n";
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int rows = argc > 1 ? QString(argv[1]).toInt() : 200000;
+    if (rows <= 0) {
+        QTextStream(stderr) << "usage: rowreader_bench [rows]\n";
+        return 1;
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "bench");
+        db.setDatabaseName(":memory:");
+        if (!db.open() || !fill(db, rows)) return 1;
+
+        QTextStream out(stdout);
+        out << "Decoding " << rows << " rows, best of " << kPasses << " passes\n";
+        report(out, "RowReader        ", rows, decodeWithReader, db);
+        report(out, "value().toX()    ", rows, decodeWithValues, db);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("bench");
+    return 0;
+}
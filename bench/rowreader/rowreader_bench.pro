@@ -0,0 +1,16 @@
+# Decode throughput of RowReader against plain QSqlQuery::value() conversions.
+# Build and run: qmake && make && ./rowreader_bench [rows]
+QT = core sql
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = rowreader_bench
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../rowreader.cpp
+
+HEADERS += \
+    ../../rowreader.h
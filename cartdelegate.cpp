@@ -0,0 +1,62 @@
+#include "cartdelegate.h"
+#include "cartmodel.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QColor>
+
+namespace {
+const QColor kButtonColor(0xe7, 0x4c, 0x3c);
+const QColor kButtonHoverColor(0xc0, 0x39, 0x2b);
+}
+
+CartDelegate::CartDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+    m_buttonFont.setBold(true);
+}
+
+QRect CartDelegate::buttonRect(const QRect &cell)
+{
+    return cell.adjusted(4, 3, -4, -3);
+}
+
+void CartDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (index.column() != CartModel::Remove) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    const QRect button = buttonRect(option.rect);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(option.state & QStyle::State_MouseOver ? kButtonHoverColor : kButtonColor);
+    painter->drawRoundedRect(button, 3, 3);
+    painter->setPen(Qt::white);
+    painter->setFont(m_buttonFont);
+    painter->drawText(button, Qt::AlignCenter, QString(QChar(0x00D7))); // ×
+    painter->restore();
+}
+
+bool CartDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                               const QModelIndex &index)
+{
+    if (index.column() != CartModel::Remove
+        || (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease)) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    const auto *mouse = static_cast<QMouseEvent *>(event);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const QPoint pos = mouse->position().toPoint();
+#else
+    const QPoint pos = mouse->pos();
+#endif
+    if (mouse->button() != Qt::LeftButton || !buttonRect(option.rect).contains(pos)) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+    // The press is swallowed too, so the line about to go isn't selected first
+    if (event->type() == QEvent::MouseButtonRelease) emit removeClicked(index.row());
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef CARTDELEGATE_H
+#define CARTDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QFont>
+
+// Draws the cart's Remove column as a red button and turns a click on it into removeClicked.
+// The other columns are painted as usual. One delegate replaces a QPushButton cell widget per
+// line, so adding or changing a line never creates or restyles widgets.
+class CartDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit CartDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+signals:
+    void removeClicked(int row);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                     const QModelIndex &index) override;
+
+private:
+    static QRect buttonRect(const QRect &cell);
+
+    QFont m_buttonFont;
+};
+
+#endif // CARTDELEGATE_H
@@ -0,0 +1,111 @@
+#include "cartmodel.h"
+
+CartModel::CartModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_total(0.0)
+{
+}
+
+int CartModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.size();
+}
+
+int CartModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CartModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.size()) return QVariant();
+
+    const SaleItem &item = m_items.at(index.row());
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case Product: return item.productName;
+        case Price: return QString::number(item.unitPrice, 'f', 2);
+        case Quantity: return QString::number(item.quantity);
+        case Total: return QString::number(item.totalPrice, 'f', 2);
+        default: return QVariant(); // Remove is painted by CartDelegate
+        }
+    }
+    if (role == Qt::TextAlignmentRole && index.column() != Product) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole && index.column() == Remove) return QString("Remove %1").arg(item.productName);
+    return QVariant();
+}
+
+QVariant CartModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case Product: return QString("Product");
+    case Price: return QString("Price");
+    case Quantity: return QString("Qty");
+    case Total: return QString("Total");
+    case Remove: return QString("Remove");
+    default: return QVariant();
+    }
+}
+
+int CartModel::indexOf(int productId) const
+{
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (m_items.at(row).productId == productId) return row;
+    }
+    return -1;
+}
+
+void CartModel::append(const SaleItem &item)
+{
+    beginInsertRows(QModelIndex(), m_items.size(), m_items.size());
+    m_items.append(item);
+    endInsertRows();
+    addToTotal(item.totalPrice);
+}
+
+bool CartModel::setQuantity(int row, int quantity)
+{
+    if (row < 0 || row >= m_items.size()) return false;
+    SaleItem &item = m_items[row];
+    if (quantity < 1 || quantity > item.available) return false;
+    if (quantity == item.quantity) return true;
+
+    const double previous = item.totalPrice;
+    item.quantity = quantity;
+    item.totalPrice = quantity * item.unitPrice;
+    emit dataChanged(index(row, Quantity), index(row, Total));
+    addToTotal(item.totalPrice - previous);
+    return true;
+}
+
+void CartModel::removeAt(int row)
+{
+    if (row < 0 || row >= m_items.size()) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    const double removed = m_items.takeAt(row).totalPrice;
+    endRemoveRows();
+    addToTotal(-removed);
+}
+
+void CartModel::clear()
+{
+    if (m_items.isEmpty()) return;
+
+    beginResetModel();
+    m_items.clear();
+    endResetModel();
+    addToTotal(-m_total);
+}
+
+void CartModel::addToTotal(double delta)
+{
+    // An empty cart is exactly zero, whatever rounding the running sum picked up
+    m_total = m_items.isEmpty() ? 0.0 : m_total + delta;
+    emit totalChanged(m_total);
+}
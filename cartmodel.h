@@ -0,0 +1,46 @@
+#ifndef CARTMODEL_H
+#define CARTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include "saleitem.h"
+
+// The lines of the sale being rung up. Every change touches only its own row: a quantity change
+// reports the Qty and Total cells of that line, an add or remove inserts or removes one row, and
+// the running total is adjusted by the difference rather than summed again.
+class CartModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { Product, Price, Quantity, Total, Remove, ColumnCount };
+
+    explicit CartModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    const QList<SaleItem> &items() const { return m_items; }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    double total() const { return m_total; }
+    int indexOf(int productId) const; // -1 if the product isn't in the cart
+
+    void append(const SaleItem &item);
+    // False, leaving the line alone, unless 1 <= quantity <= the line's available stock
+    bool setQuantity(int row, int quantity);
+    void removeAt(int row);
+    void clear();
+
+signals:
+    void totalChanged(double total);
+
+private:
+    void addToTotal(double delta);
+
+    QList<SaleItem> m_items;
+    double m_total;
+};
+
+#endif // CARTMODEL_H
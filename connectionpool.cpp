@@ -0,0 +1,217 @@
+#include "connectionpool.h"
+#include "statementcache.h"
+#include "sqldialect.h"
+#include <QThread>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QHash>
+#include <QDebug>
+
+namespace {
+// Connections idle for longer than this are pinged before being handed out again
+const qint64 kHealthCheckIdleMs = 30000;
+}
+
+ConnectionPool::ConnectionPool(const QString &sourceConnection, int maxConnections,
+                               StatementCache *statementCache, QObject *parent)
+    : QObject(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_statementCache(statementCache)
+    , m_maxConnections(qMax(1, maxConnections))
+    , m_inUse(0)
+    , m_nextId(1)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    // Only this thread's connections may be closed here. Another thread's are still closed on that
+    // thread when it finishes; the hookup made in checkout dies with the pool, so it is redone here
+    QThread *current = QThread::currentThread();
+    QStringList names;
+    QHash<QThread *, QStringList> foreign;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const auto &entry : m_entries) {
+            if (entry.inUse) {
+                qWarning() << "Connection pool destroyed while" << entry.name << "is still checked out";
+            } else if (entry.thread == current || entry.thread->isFinished()) {
+                names.append(entry.name);
+            } else {
+                foreign[entry.thread].append(entry.name);
+            }
+        }
+        m_entries.clear();
+    }
+    for (const auto &name : names) closeAndRemove(name);
+
+    for (auto it = foreign.constBegin(); it != foreign.constEnd(); ++it) {
+        const QStringList threadNames = it.value();
+        connect(it.key(), &QThread::finished, it.key(), [threadNames]() {
+            for (const auto &name : threadNames) {
+                {
+                    QSqlDatabase db = QSqlDatabase::database(name, false);
+                    if (db.isOpen()) db.close();
+                }
+                QSqlDatabase::removeDatabase(name);
+            }
+        }, Qt::DirectConnection);
+    }
+}
+
+QString ConnectionPool::checkout(int timeoutMs)
+{
+    QThread *thread = QThread::currentThread();
+    QElapsedTimer waited;
+    waited.start();
+
+    QString name;
+    qint64 idleMs = 0;
+    bool created = false;
+    bool firstForThread = true;
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_inUse >= m_maxConnections) {
+            const qint64 remaining = timeoutMs - waited.elapsed();
+            if (remaining <= 0 || !m_released.wait(&m_mutex, static_cast<unsigned long>(remaining))) {
+                qDebug() << "Connection pool exhausted after" << waited.elapsed() << "ms";
+                return QString();
+            }
+        }
+
+        for (auto &entry : m_entries) {
+            if (entry.thread != thread) continue;
+            firstForThread = false;
+            if (!entry.inUse) {
+                entry.inUse = true;
+                name = entry.name;
+                idleMs = entry.idleSince.isValid() ? entry.idleSince.elapsed() : 0;
+                break;
+            }
+        }
+
+        if (name.isEmpty()) {
+            name = QString("utilisoft_pool_%1").arg(m_nextId++);
+            m_entries.append({name, thread, true, QElapsedTimer()});
+            created = true;
+        }
+        ++m_inUse;
+    }
+
+    if (created) {
+        // Connections cannot outlive their thread, so drop them when it finishes
+        if (firstForThread) {
+            connect(thread, &QThread::finished, this, [this, thread]() {
+                dropThreadConnections(thread);
+            }, Qt::DirectConnection);
+        }
+
+        bool opened = false;
+        {
+            QSqlDatabase db = QSqlDatabase::cloneDatabase(m_sourceConnection, name);
+            db.setConnectOptions(SqlDialect::forDatabase(db)->connectOptions(SqlDialect::kBackgroundTimeoutSecs));
+            opened = db.open();
+            if (!opened) qDebug() << "Pool connection failed:" << db.lastError().text();
+            else if (!SqlDialect::forDatabase(db)->prepareConnection(db)) opened = false;
+        }
+        if (!opened) {
+            {
+                QMutexLocker locker(&m_mutex);
+                for (int i = 0; i < m_entries.size(); ++i) {
+                    if (m_entries[i].name == name) {
+                        m_entries.removeAt(i);
+                        break;
+                    }
+                }
+                --m_inUse;
+                m_released.wakeOne();
+            }
+            QSqlDatabase::removeDatabase(name);
+            return QString();
+        }
+    } else if (!ensureHealthy(name, idleMs)) {
+        release(name);
+        return QString();
+    }
+
+    return name;
+}
+
+void ConnectionPool::release(const QString &connectionName)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto &entry : m_entries) {
+        if (entry.name == connectionName && entry.inUse) {
+            entry.inUse = false;
+            entry.idleSince.start();
+            --m_inUse;
+            m_released.wakeOne();
+            return;
+        }
+    }
+}
+
+void ConnectionPool::setMaxConnections(int maxConnections)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxConnections = qMax(1, maxConnections);
+    m_released.wakeAll();
+}
+
+int ConnectionPool::maxConnections() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxConnections;
+}
+
+int ConnectionPool::inUseCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_inUse;
+}
+
+bool ConnectionPool::ensureHealthy(const QString &connectionName, qint64 idleMs)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (db.isOpen() && idleMs < kHealthCheckIdleMs) return true;
+
+    if (db.isOpen()) {
+        QSqlQuery ping(db);
+        if (ping.exec("SELECT 1")) return true;
+        qDebug() << "Pool connection" << connectionName << "failed health check:" << ping.lastError().text();
+        m_statementCache->invalidate(connectionName);
+        db.close();
+    }
+    if (!db.open()) {
+        qDebug() << "Pool connection reopen failed:" << db.lastError().text();
+        return false;
+    }
+    return SqlDialect::forDatabase(db)->prepareConnection(db);
+}
+
+void ConnectionPool::dropThreadConnections(QThread *thread)
+{
+    QStringList names;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (int i = m_entries.size() - 1; i >= 0; --i) {
+            if (m_entries[i].thread != thread) continue;
+            if (m_entries[i].inUse) --m_inUse;
+            names.append(m_entries[i].name);
+            m_entries.removeAt(i);
+        }
+        m_released.wakeAll();
+    }
+    for (const auto &name : names) closeAndRemove(name);
+}
+
+void ConnectionPool::closeAndRemove(const QString &connectionName)
+{
+    m_statementCache->invalidate(connectionName);
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
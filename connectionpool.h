@@ -0,0 +1,77 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QList>
+
+class QThread;
+class StatementCache;
+
+// Hands out named connections cloned from a source connection. QSqlDatabase handles may only be
+// used on the thread that opened them, so each connection is bound to the thread that created it
+// and is reused by later checkouts on that thread. maxConnections caps how many can be checked
+// out at once; idle connections are health-checked before being handed out again.
+class ConnectionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConnectionPool(const QString &sourceConnection, int maxConnections,
+                            StatementCache *statementCache, QObject *parent = nullptr);
+    ~ConnectionPool();
+
+    // Returns a connection name usable on the calling thread, or an empty string on timeout/failure
+    QString checkout(int timeoutMs = 5000);
+    void release(const QString &connectionName);
+
+    void setMaxConnections(int maxConnections);
+    int maxConnections() const;
+    int inUseCount() const;
+
+private:
+    struct Entry {
+        QString name;
+        QThread *thread;
+        bool inUse;
+        QElapsedTimer idleSince;
+    };
+
+    bool ensureHealthy(const QString &connectionName, qint64 idleMs);
+    void dropThreadConnections(QThread *thread);
+    void closeAndRemove(const QString &connectionName);
+
+    QString m_sourceConnection;
+    StatementCache *m_statementCache;
+    int m_maxConnections;
+    int m_inUse;
+    int m_nextId;
+    QList<Entry> m_entries;
+    mutable QMutex m_mutex;
+    QWaitCondition m_released;
+};
+
+// RAII checkout: returns the connection to the pool when it goes out of scope
+class PooledConnection
+{
+public:
+    explicit PooledConnection(ConnectionPool *pool, int timeoutMs = 5000)
+        : m_pool(pool), m_name(pool ? pool->checkout(timeoutMs) : QString()) {}
+    ~PooledConnection() { if (m_pool && !m_name.isEmpty()) m_pool->release(m_name); }
+
+    PooledConnection(const PooledConnection &) = delete;
+    PooledConnection &operator=(const PooledConnection &) = delete;
+
+    bool isValid() const { return !m_name.isEmpty(); }
+    QString name() const { return m_name; }
+    QSqlDatabase database() const { return QSqlDatabase::database(m_name, false); }
+
+private:
+    ConnectionPool *m_pool;
+    QString m_name;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -0,0 +1,127 @@
+#include "dashboardcounters.h"
+#include "connectionpool.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QtConcurrent>
+#include <QDebug>
+
+namespace {
+const int kDefaultVerifyIntervalMs = 5 * 60 * 1000;
+}
+
+DashboardCounters::DashboardCounters(ConnectionPool *pool, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_generation(0)
+    , m_verifyGeneration(0)
+{
+    m_verifyTimer.setInterval(kDefaultVerifyIntervalMs);
+    connect(&m_verifyTimer, &QTimer::timeout, this, &DashboardCounters::verify);
+    connect(&m_verifyWatcher, &QFutureWatcher<DashboardTotals>::finished, this, &DashboardCounters::onVerifyFinished);
+}
+
+DashboardCounters::~DashboardCounters()
+{
+    m_verifyWatcher.waitForFinished(); // The query holds a pooled connection
+}
+
+bool DashboardCounters::seed()
+{
+    const DashboardTotals totals = queryTotals(m_pool);
+    if (!totals.valid) return false;
+
+    m_totals = totals;
+    ++m_generation;
+    m_verifyTimer.start();
+    emit countersChanged();
+    return true;
+}
+
+void DashboardCounters::reset()
+{
+    m_verifyTimer.stop();
+    m_totals = DashboardTotals();
+    ++m_generation; // A verify still running belongs to the old session
+}
+
+void DashboardCounters::addDebtors(int count, double amount)
+{
+    if (!m_totals.valid) return;
+    m_totals.debtors += count;
+    m_totals.debt += amount;
+    applied();
+}
+
+void DashboardCounters::addProducts(int count, qint64 stock)
+{
+    if (!m_totals.valid) return;
+    m_totals.products += count;
+    m_totals.stock += stock;
+    applied();
+}
+
+void DashboardCounters::addSales(int orders, double amount, qint64 unitsSold)
+{
+    if (!m_totals.valid) return;
+    m_totals.sales += orders;
+    m_totals.salesAmount += amount;
+    m_totals.stock -= unitsSold;
+    applied();
+}
+
+void DashboardCounters::applied()
+{
+    ++m_generation;
+    emit countersChanged();
+}
+
+void DashboardCounters::verify()
+{
+    if (!m_totals.valid || m_verifyWatcher.isRunning()) return;
+
+    m_verifyGeneration = m_generation;
+    ConnectionPool *pool = m_pool;
+    m_verifyWatcher.setFuture(QtConcurrent::run([pool]() { return queryTotals(pool); }));
+}
+
+void DashboardCounters::onVerifyFinished()
+{
+    const DashboardTotals fresh = m_verifyWatcher.result();
+    // A delta landed while the query ran, so the snapshot may predate it; the next tick retries
+    if (!fresh.valid || !m_totals.valid || m_verifyGeneration != m_generation) return;
+
+    if (fresh.debtors != m_totals.debtors || fresh.products != m_totals.products
+        || fresh.stock != m_totals.stock || fresh.sales != m_totals.sales
+        || !qFuzzyCompare(1.0 + fresh.debt, 1.0 + m_totals.debt)
+        || !qFuzzyCompare(1.0 + fresh.salesAmount, 1.0 + m_totals.salesAmount)) {
+        qDebug() << "Dashboard counters drifted from the database; correcting";
+        m_totals = fresh;
+        emit countersChanged();
+    }
+}
+
+DashboardTotals DashboardCounters::queryTotals(ConnectionPool *pool)
+{
+    DashboardTotals totals;
+    PooledConnection connection(pool);
+    if (!connection.isValid()) return totals;
+
+    QSqlQuery query(connection.database());
+    if (!query.exec("SELECT "
+                    "(SELECT COUNT(*) FROM Debtors), (SELECT COALESCE(SUM(debt_amount), 0) FROM Debtors), "
+                    "(SELECT COUNT(*) FROM Products), (SELECT COALESCE(SUM(quantity), 0) FROM Products), "
+                    "(SELECT COUNT(*) FROM Orders), (SELECT COALESCE(SUM(total_amount), 0) FROM Orders)")
+        || !query.next()) {
+        qDebug() << "Failed to query dashboard counters:" << query.lastError().text();
+        return totals;
+    }
+
+    totals.debtors = query.value(0).toInt();
+    totals.debt = query.value(1).toDouble();
+    totals.products = query.value(2).toInt();
+    totals.stock = query.value(3).toLongLong();
+    totals.sales = query.value(4).toInt();
+    totals.salesAmount = query.value(5).toDouble();
+    totals.valid = true;
+    return totals;
+}
@@ -0,0 +1,63 @@
+#ifndef DASHBOARDCOUNTERS_H
+#define DASHBOARDCOUNTERS_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+
+class ConnectionPool;
+
+struct DashboardTotals {
+    bool valid = false;
+    int debtors = 0;
+    double debt = 0.0;
+    int products = 0;
+    qint64 stock = 0;
+    int sales = 0; // Orders, not lines
+    double salesAmount = 0.0;
+};
+
+// In-process cache of the dashboard counters. It is seeded with one aggregate query at login and
+// then moved by deltas reported from the manager mutations, so the labels never need a COUNT/SUM
+// scan. A background re-verify periodically recomputes the totals and corrects any drift.
+// Lives on the GUI thread; deltas must be applied there.
+class DashboardCounters : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DashboardCounters(ConnectionPool *pool, QObject *parent = nullptr);
+    ~DashboardCounters();
+
+    bool seed();
+    void reset();
+    bool isSeeded() const { return m_totals.valid; }
+    DashboardTotals totals() const { return m_totals; }
+
+    // Deltas; negative values for removals
+    void addDebtors(int count, double amount);
+    void addProducts(int count, qint64 stock);
+    void addSales(int orders, double amount, qint64 unitsSold);
+
+    void setVerifyInterval(int msec) { m_verifyTimer.setInterval(msec); }
+
+signals:
+    void countersChanged();
+
+private slots:
+    void verify();
+    void onVerifyFinished();
+
+private:
+    static DashboardTotals queryTotals(ConnectionPool *pool);
+    void applied();
+
+    ConnectionPool *m_pool;
+    DashboardTotals m_totals;
+    quint64 m_generation;       // Bumped by every delta
+    quint64 m_verifyGeneration; // Generation the running verify started from
+    QTimer m_verifyTimer;
+    QFutureWatcher<DashboardTotals> m_verifyWatcher;
+};
+
+#endif // DASHBOARDCOUNTERS_H
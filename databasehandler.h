@@ -6,29 +6,95 @@
 #include <QDebug>
 #include <QSqlQuery>
 #include <QSqlQueryModel>
+#include <QFuture>
+#include <QtConcurrent>
+#include <algorithm>
+#include "databaseworker.h"
+#include "connectionpool.h"
+#include "statementcache.h"
+#include "dashboardcounters.h"
+#include "productindex.h"
+#include "sqldialect.h"
+#include "schemamigrator.h"
+
 class DatabaseHandler : public QObject
 {
     Q_OBJECT
 public:
-    explicit DatabaseHandler(QObject *parent = nullptr) : QObject(parent), m_loggedIn(false), m_isAdmin(false), m_userId(-1) {
-        db = QSqlDatabase::addDatabase("QMYSQL");
-        db.setHostName("localhost");
-        db.setDatabaseName("utilisoft");
-        db.setUserName("root");
-        db.setPassword("");
+    explicit DatabaseHandler(QObject *parent = nullptr) : QObject(parent), m_schemaReady(false), m_loggedIn(false), m_isAdmin(false), m_userId(-1) {
+        // [database] backend=mysql (default) or sqlite for a single till without a server
+        QSettings settings;
+        settings.beginGroup("database");
+        const QString backend = settings.value("backend", "mysql").toString();
+        m_dialect = SqlDialect::lookup(backend);
+        if (!m_dialect) {
+            qDebug() << "Unknown database backend" << backend << "- using mysql";
+            m_dialect = SqlDialect::lookup("mysql");
+        }
+
+        db = QSqlDatabase::addDatabase(m_dialect->driverName());
+        if (m_dialect->isEmbedded()) {
+            const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+            QDir().mkpath(dataDir);
+            db.setDatabaseName(settings.value("path", dataDir + "/utilisoft.sqlite").toString());
+        } else {
+            db.setHostName(settings.value("host", "localhost").toString());
+            db.setDatabaseName(settings.value("name", "utilisoft").toString());
+            db.setUserName(settings.value("user", "root").toString());
+            db.setPassword(settings.value("password", "").toString());
+        }
+        db.setConnectOptions(m_dialect->connectOptions(SqlDialect::kInteractiveTimeoutSecs));
+        m_statementCache = new StatementCache();
+        m_worker = new DatabaseWorker(QSqlDatabase::defaultConnection, m_statementCache, this);
+        m_pool = new ConnectionPool(QSqlDatabase::defaultConnection, QThread::idealThreadCount(),
+                                    m_statementCache, this);
+        m_counters = new DashboardCounters(m_pool, this);
+        m_productIndex = new ProductIndex(m_pool, this);
     }
 
-    ~DatabaseHandler() { if (db.isOpen()) db.close(); }
+    ~DatabaseHandler() {
+        m_worker->stop();
+        m_worker->wait();
+        for (auto &kill : m_kills) kill.waitForFinished(); // Each holds a pooled connection
+        delete m_counters; // Waits for a background re-verify that holds a pooled connection
+        delete m_productIndex; // Same for a background rebuild
+        delete m_pool; // Its connections must be released before the statement cache goes away
+        m_statementCache->clear();
+        if (db.isOpen()) db.close();
+        delete m_statementCache;
+    }
 
     bool connectToDatabase() {
+        m_statementCache->invalidate(db.connectionName()); // Prepared statements don't survive a reconnect
         if (!db.open()) {
             qDebug() << "Database connection failed:" << db.lastError().text();
             return false;
         }
-        qDebug() << "Database connected successfully";
+        if (!m_dialect->prepareConnection(db)) {
+            db.close();
+            return false;
+        }
+        if (!m_schemaReady) {
+            // Once per run; a reconnect finds the same schema
+            SchemaMigrator migrator(db, m_dialect);
+            if (!migrator.migrate()) {
+                db.close();
+                return false;
+            }
+            migrator.verifyIndexes();
+            m_schemaReady = true;
+        }
+        qDebug() << "Database connected successfully (" << m_dialect->name() << ")";
+        if (!m_worker->isRunning()) m_worker->start();
         return true;
     }
 
+    // Reopens the default connection after the server went away
+    bool reconnect() {
+        db.close();
+        return connectToDatabase();
+    }
+
     bool login(const QString &username, const QString &password) {
         if (!db.isOpen() && !connectToDatabase()) return false;
 
@@ -41,6 +107,7 @@ public:
             m_userId = q.value(0).toInt();
             m_isAdmin = q.value(1).toBool();
             m_loggedIn = true;
+            if (!m_counters->isSeeded()) m_counters->seed();
             emit loginStatusChanged(true, m_isAdmin);
             return true;
         }
@@ -50,12 +117,14 @@ public:
     void logout() {
         if (db.isOpen() && m_userId != -1) { // Check if DB is open and user is valid
             QSqlQuery query(db); // Pass the database connection to the query
-            query.prepare("UPDATE Users SET last_logout = NOW() WHERE user_id = :userId");
+            query.prepare("UPDATE Users SET last_logout = " + m_dialect->now() + " WHERE user_id = :userId");
             query.bindValue(":userId", m_userId);
             if (!query.exec()) {
                 qDebug() << "Logout query failed:" << query.lastError().text();
             }
         }
+        m_counters->reset();
+        m_productIndex->clear();
         m_loggedIn = m_isAdmin = false;
         m_userId = -1;
         emit loginStatusChanged(false, false);
@@ -79,12 +148,52 @@ public:
     int getCurrentUserId() const { return m_userId; }
     bool isConnected() const { return db.isOpen(); }
     QSqlDatabase getDatabase() const { return db; }
+    DatabaseWorker *worker() const { return m_worker; }
+    ConnectionPool *pool() const { return m_pool; }
+    StatementCache *statementCache() const { return m_statementCache; }
+    DashboardCounters *counters() const { return m_counters; }
+    ProductIndex *productIndex() const { return m_productIndex; }
+    const SqlDialect *dialect() const { return m_dialect; }
+    // Prepared query on the main connection, reused across calls with the same SQL text
+    CachedQuery cachedQuery(const QString &sql) { return m_statementCache->acquire(db, sql); }
+    void setPoolSize(int size) { m_pool->setMaxConnections(size); }
+
+    // Cancel a worker request; one already running on the server is stopped with KILL QUERY
+    void cancelQuery(quint64 requestId) {
+        if (!m_worker->cancel(requestId)) return;
+        const qint64 connectionId = m_worker->serverConnectionId();
+        const QString cancel = m_dialect->cancelStatement(connectionId);
+        if (connectionId < 0 || cancel.isEmpty()) return; // Embedded queries are local and short
+
+        // The checkout may wait for a free connection or dial a new one, and KILL is another
+        // round trip; neither belongs on the GUI thread. A kill that lands after the query
+        // finished is absorbed by the worker, which reruns an interrupted request nobody cancelled.
+        m_kills.erase(std::remove_if(m_kills.begin(), m_kills.end(),
+                                     [](const QFuture<void> &kill) { return kill.isFinished(); }),
+                      m_kills.end());
+        m_kills.append(QtConcurrent::run([pool = m_pool, cancel]() {
+            PooledConnection connection(pool);
+            if (!connection.isValid()) return;
+            QSqlQuery kill(connection.database());
+            if (!kill.exec(cancel)) {
+                qDebug() << "KILL QUERY failed:" << kill.lastError().text();
+            }
+        }));
+    }
 
 signals:
     void loginStatusChanged(bool loggedIn, bool isAdmin);
 
 private:
     QSqlDatabase db;
+    const SqlDialect *m_dialect;
+    bool m_schemaReady;
+    DatabaseWorker *m_worker;
+    ConnectionPool *m_pool;
+    StatementCache *m_statementCache;
+    DashboardCounters *m_counters;
+    ProductIndex *m_productIndex;
+    QList<QFuture<void>> m_kills; // KILL QUERY tasks still running
     bool m_loggedIn, m_isAdmin;
     int m_userId;
 };
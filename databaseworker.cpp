@@ -0,0 +1,184 @@
+#include "databaseworker.h"
+#include "statementcache.h"
+#include "sqldialect.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QDebug>
+
+DatabaseWorker::DatabaseWorker(const QString &sourceConnection, StatementCache *statementCache,
+                               QObject *parent)
+    : QThread(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_connectionName(QString("utilisoft_worker_%1").arg(reinterpret_cast<quintptr>(this)))
+    , m_statementCache(statementCache)
+    , m_nextId(1)
+    , m_stopping(false)
+    , m_runningId(0)
+    , m_serverConnectionId(-1)
+{
+    qRegisterMetaType<DbResult>("DbResult");
+}
+
+DatabaseWorker::~DatabaseWorker()
+{
+    stop();
+    wait();
+}
+
+quint64 DatabaseWorker::submit(const QString &sql, const QVariantList &params, Priority priority)
+{
+    QMutexLocker locker(&m_mutex);
+    const quint64 id = m_nextId++;
+    m_queue.push({id, priority, sql, params});
+    m_queuedIds.insert(id);
+    m_condition.wakeOne();
+    return id;
+}
+
+void DatabaseWorker::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_condition.wakeAll();
+}
+
+int DatabaseWorker::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_queue.size());
+}
+
+bool DatabaseWorker::cancel(quint64 requestId)
+{
+    QMutexLocker locker(&m_mutex);
+    const bool running = requestId != 0 && requestId == m_runningId;
+    if (!running && !m_queuedIds.contains(requestId)) return false; // Already finished
+    m_cancelled.insert(requestId);
+    return running;
+}
+
+qint64 DatabaseWorker::serverConnectionId() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_serverConnectionId;
+}
+
+bool DatabaseWorker::isCancelled(quint64 requestId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cancelled.contains(requestId);
+}
+
+void DatabaseWorker::readServerConnectionId(const QSqlDatabase &db)
+{
+    const QString sql = SqlDialect::forDatabase(db)->connectionIdQuery();
+    QSqlQuery query(db);
+    const qint64 id = !sql.isEmpty() && query.exec(sql) && query.next() ? query.value(0).toLongLong() : -1;
+    QMutexLocker locker(&m_mutex);
+    m_serverConnectionId = id;
+}
+
+void DatabaseWorker::run()
+{
+    {
+        // The connection must be created and used on this thread only
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(m_sourceConnection, m_connectionName);
+        db.setConnectOptions(SqlDialect::forDatabase(db)->connectOptions(SqlDialect::kBackgroundTimeoutSecs));
+        if (!db.open()) {
+            qDebug() << "Worker connection failed:" << db.lastError().text();
+        } else {
+            SqlDialect::forDatabase(db)->prepareConnection(db);
+            readServerConnectionId(db);
+        }
+
+        for (;;) {
+            Request request;
+            bool skipped = false;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (m_queue.empty() && !m_stopping) m_condition.wait(&m_mutex);
+                if (m_stopping) break;
+                request = m_queue.top();
+                m_queue.pop();
+                m_queuedIds.remove(request.id);
+                skipped = m_cancelled.remove(request.id);
+                if (!skipped) m_runningId = request.id;
+            }
+
+            DbResult result;
+            if (skipped) {
+                result.cancelled = true;
+                result.error = "Cancelled";
+            } else {
+                result = execute(request);
+                QMutexLocker locker(&m_mutex);
+                m_runningId = 0;
+                if (m_cancelled.remove(request.id)) result.cancelled = true;
+            }
+            emit queryFinished(request.id, result);
+        }
+
+        m_statementCache->invalidate(m_connectionName);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+DbResult DatabaseWorker::execute(const Request &request)
+{
+    DbResult result;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    if (!db.isOpen()) {
+        m_statementCache->invalidate(m_connectionName); // Statements died with the old session
+        if (!db.open()) {
+            result.error = db.lastError().text();
+            return result;
+        }
+        SqlDialect::forDatabase(db)->prepareConnection(db);
+        readServerConnectionId(db);
+    }
+
+    CachedQuery cached = m_statementCache->acquire(db, request.sql);
+    if (!cached) {
+        result.error = db.lastError().text();
+        return result;
+    }
+    QSqlQuery &query = *cached;
+    for (const auto &param : request.params) {
+        query.addBindValue(param);
+    }
+    bool ok = query.exec();
+    // An interrupted request nobody cancelled means a KILL QUERY aimed at the previous request
+    // landed late; the bound values are kept, so just run it again
+    if (!ok && SqlDialect::forDatabase(db)->isInterrupted(query.lastError()) && !isCancelled(request.id)) {
+        ok = query.exec();
+    }
+    if (!ok) {
+        result.error = query.lastError().text();
+        if (!isCancelled(request.id)) qDebug() << "Worker query failed:" << result.error;
+        return result;
+    }
+
+    const QSqlRecord record = query.record();
+    const int columnCount = record.count();
+    for (int col = 0; col < columnCount; ++col) {
+        result.columns.append(record.fieldName(col));
+    }
+    while (query.next()) {
+        QVariantList row;
+        row.reserve(columnCount);
+        for (int col = 0; col < columnCount; ++col) {
+            row.append(query.value(col));
+        }
+        result.rows.append(row);
+    }
+
+    result.ok = true;
+    result.numRowsAffected = query.numRowsAffected();
+    result.lastInsertId = query.lastInsertId();
+    query.finish();
+    return result;
+}
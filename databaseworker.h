@@ -0,0 +1,93 @@
+#ifndef DATABASEWORKER_H
+#define DATABASEWORKER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVariant>
+#include <QStringList>
+#include <QVector>
+#include <QSet>
+#include <queue>
+#include <vector>
+
+class StatementCache;
+class QSqlDatabase;
+
+// Rows fetched by the worker, copied out of QSqlQuery so they can cross threads
+struct DbResult {
+    bool ok = false;
+    bool cancelled = false; // Dropped from the queue or interrupted by cancel()
+    QString error;
+    QStringList columns;
+    QVector<QVariantList> rows;
+    int numRowsAffected = -1;
+    QVariant lastInsertId;
+};
+Q_DECLARE_METATYPE(DbResult)
+
+// Runs queued SQL on its own thread and connection so the GUI never blocks on MySQL.
+// Interactive requests (search-as-you-type, cart lookups) jump ahead of background refreshes.
+class DatabaseWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Priority { Interactive = 0, Normal = 1, Background = 2 };
+    Q_ENUM(Priority)
+
+    explicit DatabaseWorker(const QString &sourceConnection, StatementCache *statementCache,
+                            QObject *parent = nullptr);
+    ~DatabaseWorker();
+
+    // Queue a statement; returns the request id echoed back in queryFinished()
+    quint64 submit(const QString &sql, const QVariantList &params = {}, Priority priority = Normal);
+    void stop();
+    int pendingCount() const;
+
+    // Cancel a request. Queued requests are skipped; returns true if the request is executing
+    // right now, in which case the caller should KILL QUERY serverConnectionId() from another
+    // connection. Either way queryFinished() reports it with cancelled set.
+    bool cancel(quint64 requestId);
+    qint64 serverConnectionId() const;
+
+signals:
+    void queryFinished(quint64 requestId, const DbResult &result);
+
+protected:
+    void run() override;
+
+private:
+    struct Request {
+        quint64 id;
+        Priority priority;
+        QString sql;
+        QVariantList params;
+    };
+    struct RequestOrder {
+        // priority_queue pops the "largest" element, so invert: lower priority value and older id win
+        bool operator()(const Request &a, const Request &b) const {
+            return a.priority != b.priority ? a.priority > b.priority : a.id > b.id;
+        }
+    };
+
+    DbResult execute(const Request &request);
+    bool isCancelled(quint64 requestId) const;
+    void readServerConnectionId(const QSqlDatabase &db);
+
+    QString m_sourceConnection;
+    QString m_connectionName;
+    StatementCache *m_statementCache;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::priority_queue<Request, std::vector<Request>, RequestOrder> m_queue;
+    quint64 m_nextId;
+    bool m_stopping;
+    QSet<quint64> m_queuedIds;
+    QSet<quint64> m_cancelled;
+    quint64 m_runningId;        // 0 while idle
+    qint64 m_serverConnectionId; // MySQL CONNECTION_ID() of the worker's session, -1 if unknown
+};
+
+#endif // DATABASEWORKER_H
@@ -4,23 +4,26 @@
 #include <QDebug>
 
 DebtManager::DebtManager(DatabaseHandler *dbHandler, QObject *parent)
-    : QObject(parent), m_dbHandler(dbHandler) {}
+    : QObject(parent), m_dbHandler(dbHandler), m_loader(new ModelLoader(dbHandler, "debtors", this)) {}
 
-bool DebtManager::loadDebtors(QTableWidget *tableWidget)
+RowBufferModel *DebtManager::createModel(const QStringList &headers, QObject *parent)
 {
-    return populateTable(tableWidget,
-                         "SELECT debtor_id, name, contact_number, address, debt_amount, date_incurred "
-                         "FROM Debtors ORDER BY name");
+    return new TableModel<DebtorsTable>(headers, parent);
 }
 
-void DebtManager::searchDebtors(QTableWidget *tableWidget, const QString &searchText)
+bool DebtManager::loadDebtors(RowBufferModel *model)
 {
-    QSqlQuery query;
-    query.prepare("SELECT debtor_id, name, contact_number, address, debt_amount, date_incurred "
-                  "FROM Debtors WHERE CONCAT(name, contact_number, address) LIKE ? ORDER BY name");
-    query.addBindValue("%" + searchText + "%");
+    return m_loader->submit(model, TableSql<DebtorsTable>::select() + " ORDER BY name",
+                            {}, DatabaseWorker::Background) != 0;
+}
 
-    populateTableWithQuery(tableWidget, query);
+quint64 DebtManager::searchDebtors(RowBufferModel *model, const QString &searchText)
+{
+    return m_loader->submit(model,
+                            TableSql<DebtorsTable>::select() + " WHERE "
+                            + m_dbHandler->dialect()->concat({"name", "contact_number", "address"})
+                            + " LIKE ? ORDER BY name",
+                            {"%" + searchText + "%"}, DatabaseWorker::Interactive);
 }
 
 bool DebtManager::addDebtor(const QString &name, const QString &contact,
@@ -29,8 +32,7 @@ bool DebtManager::addDebtor(const QString &name, const QString &contact,
     if (!m_dbHandler->isConnected()) return false;
 
     QSqlQuery query;
-    query.prepare("INSERT INTO Debtors (name, contact_number, address, debt_amount, date_incurred) "
-                  "VALUES (?, ?, ?, ?, ?)");
+    query.prepare(TableSql<DebtorsTable>::insert());
     query.addBindValue(name);
     query.addBindValue(contact);
     query.addBindValue(address);
@@ -38,70 +40,62 @@ bool DebtManager::addDebtor(const QString &name, const QString &contact,
     query.addBindValue(dateIncurred);
 
     bool success = query.exec();
-    if (success) emit debtorsUpdated();
-    else qDebug() << "Failed to add debtor:" << query.lastError().text();
+    if (success) {
+        m_dbHandler->counters()->addDebtors(1, debtAmount);
+        emit debtorsUpdated();
+    } else {
+        qDebug() << "Failed to add debtor:" << query.lastError().text();
+    }
     return success;
 }
 
 bool DebtManager::removeDebtor(int debtorId)
-{
-    return executeQuery("DELETE FROM Debtors WHERE debtor_id = ?", {debtorId});
-}
-
-bool DebtManager::getDebtorStats(int &totalDebtors, double &totalDebt)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query("SELECT COUNT(*) as count, COALESCE(SUM(debt_amount), 0) as total FROM Debtors");
-    if (query.exec() && query.next()) {
-        totalDebtors = query.value(0).toInt();
-        totalDebt = query.value(1).toDouble();
-        return true;
-    }
-    return false;
-}
-
-// Private helper methods
-bool DebtManager::populateTable(QTableWidget *tableWidget, const QString &sql)
-{
-    QSqlQuery query(sql);
-    return populateTableWithQuery(tableWidget, query);
-}
+    // Read the amount in the same transaction so the counters get the exact delta
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
 
-bool DebtManager::populateTableWithQuery(QTableWidget *tableWidget, QSqlQuery &query)
-{
-    if (!m_dbHandler->isConnected() || !query.exec()) {
+    QSqlQuery query;
+    query.prepare("SELECT debt_amount FROM Debtors WHERE debtor_id = ?" + m_dbHandler->dialect()->forUpdate());
+    query.addBindValue(debtorId);
+    if (!query.exec()) {
         qDebug() << "Query failed:" << query.lastError().text();
+        db.rollback();
         return false;
     }
+    const bool found = query.next();
+    const double amount = found ? query.value(0).toDouble() : 0.0;
 
-    tableWidget->setRowCount(0);
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
-        for (int col = 0; col < 5; col++) {
-            tableWidget->setItem(row, col, new QTableWidgetItem(query.value(col).toString()));
-        }
-        // Format date for last column
-        tableWidget->setItem(row, 5, new QTableWidgetItem(
-                                         query.value(5).toDate().toString("yyyy-MM-dd")));
-        row++;
+    query.prepare("DELETE FROM Debtors WHERE debtor_id = ?");
+    query.addBindValue(debtorId);
+    if (!query.exec()) {
+        qDebug() << "Query failed:" << query.lastError().text();
+        db.rollback();
+        return false;
     }
+
+    db.commit();
+    if (found) m_dbHandler->counters()->addDebtors(-1, -amount);
+    emit debtorsUpdated();
     return true;
 }
 
-bool DebtManager::executeQuery(const QString &sql, const QVariantList &params)
+bool DebtManager::getDebtorStats(int &totalDebtors, double &totalDebt)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query;
-    query.prepare(sql);
-    for (const auto &param : params) {
-        query.addBindValue(param);
-    }
+    // Uses a pooled connection so it can run alongside the other dashboard stats
+    PooledConnection connection(m_dbHandler->pool());
+    if (!connection.isValid()) return false;
 
-    bool success = query.exec();
-    if (success) emit debtorsUpdated();
-    else qDebug() << "Query failed:" << query.lastError().text();
-    return success;
+    QSqlQuery query(connection.database());
+    if (query.exec("SELECT COUNT(*) as count, COALESCE(SUM(debt_amount), 0) as total FROM Debtors") && query.next()) {
+        totalDebtors = query.value(0).toInt();
+        totalDebt = query.value(1).toDouble();
+        return true;
+    }
+    return false;
 }
+
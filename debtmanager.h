@@ -2,10 +2,12 @@
 #define DEBTMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
 #include <QDate>
 #include <QSqlQuery>
 #include "databasehandler.h"
+#include "rowbuffermodel.h"
+#include "modelloader.h"
+#include "tables.h"
 
 class DebtManager : public QObject
 {
@@ -13,8 +15,11 @@ class DebtManager : public QObject
 public:
     explicit DebtManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
 
-    bool loadDebtors(QTableWidget *tableWidget);
-    void searchDebtors(QTableWidget *tableWidget, const QString &searchText);
+    // Model laid out as DebtorsTable, like every debtor SELECT below
+    static RowBufferModel *createModel(const QStringList &headers, QObject *parent = nullptr);
+
+    bool loadDebtors(RowBufferModel *model);
+    quint64 searchDebtors(RowBufferModel *model, const QString &searchText); // Worker request id
     bool addDebtor(const QString &name, const QString &contact,
                    const QString &address, double debtAmount, const QDate &dateIncurred);
     bool removeDebtor(int debtorId);
@@ -25,11 +30,7 @@ signals:
 
 private:
     DatabaseHandler *m_dbHandler;
-
-    // Helper methods to reduce code duplication
-    bool populateTable(QTableWidget *tableWidget, const QString &sql);
-    bool populateTableWithQuery(QTableWidget *tableWidget, QSqlQuery &query);
-    bool executeQuery(const QString &sql, const QVariantList &params = {});
+    ModelLoader *m_loader;
 };
 
 #endif // DEBTMANAGER_H
@@ -1,6 +1,7 @@
 QT       += core gui sql
 QT += qml
 QT       += core gui charts
+QT       += concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -11,28 +12,71 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    cartdelegate.cpp \
+    cartmodel.cpp \
+    connectionpool.cpp \
+    dashboardcounters.cpp \
+    databaseworker.cpp \
     debtmanager.cpp \
+    latencyhistogram.cpp \
     main.cpp \
+    modelloader.cpp \
     mainwindow.cpp \
+    productindex.cpp \
+    productimporter.cpp \
     productmanager.cpp \
+    recommendationdelegate.cpp \
+    recommendationmodel.cpp \
     salesdashboard.cpp \
+    refreshscheduler.cpp \
+    rowbuffermodel.cpp \
+    rowreader.cpp \
+    saleshistorymodel.cpp \
+    schemamigrator.cpp \
+    searchcontroller.cpp \
+    sqldialect.cpp \
+    salejournal.cpp \
+    salesexporter.cpp \
     salesmanager.cpp \
+    statementcache.cpp \
     stockmanager.cpp \
     vendormanager.cpp \
     workermanager.cpp
 
 HEADERS += \
     debtmanager.h \
+    latencyhistogram.h \
     mainwindow.h \
     databasehandler.h \
+    cartdelegate.h \
+    cartmodel.h \
+    connectionpool.h \
+    dashboardcounters.h \
+    databaseworker.h \
+    modelloader.h \
+    productindex.h \
+    productimporter.h \
     productmanager.h \
+    recommendationdelegate.h \
+    recommendationmodel.h \
     saleitem.h \
     salesdashboard.h \
+    refreshscheduler.h \
+    rowbuffermodel.h \
+    rowreader.h \
+    saleshistorymodel.h \
+    schemamigrator.h \
+    searchcontroller.h \
+    sqldialect.h \
+    salejournal.h \
+    salesexporter.h \
     salesmanager.h \
+    statementcache.h \
     stockmanager.h \
+    tabledescriptor.h \
+    tables.h \
     vendormanager.h \
-    workermanager.h \
-    clickableWidget.h
+    workermanager.h
 
 FORMS += \
     mainwindow.ui
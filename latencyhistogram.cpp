@@ -0,0 +1,49 @@
+#include "latencyhistogram.h"
+
+void LatencyHistogram::record(qint64 nsecs)
+{
+    if (nsecs < 0) nsecs = 0;
+    qint64 micros = nsecs / 1000;
+    int bucket = 0;
+    while (micros > 0 && bucket < kBuckets - 1) {
+        micros >>= 1;
+        ++bucket;
+    }
+
+    ++m_buckets[bucket];
+    ++m_count;
+    m_totalNsecs += nsecs;
+    if (nsecs > m_maxNsecs) m_maxNsecs = nsecs;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_totalNsecs = 0;
+    m_maxNsecs = 0;
+}
+
+qint64 LatencyHistogram::percentileMicros(double percentile) const
+{
+    if (m_count == 0) return 0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(percentile / 100.0 * m_count + 0.5));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) return qint64(1) << bucket;
+    }
+    return qint64(1) << (kBuckets - 1);
+}
+
+QString LatencyHistogram::summary() const
+{
+    return QString("n=%1 mean=%2us p50<=%3us p90<=%4us p99<=%5us max=%6us")
+        .arg(m_count)
+        .arg(meanMicros(), 0, 'f', 1)
+        .arg(percentileMicros(50))
+        .arg(percentileMicros(90))
+        .arg(percentileMicros(99))
+        .arg(m_maxNsecs / 1000.0, 0, 'f', 1);
+}
@@ -0,0 +1,35 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QtGlobal>
+#include <array>
+
+// Fixed-size latency histogram with power-of-two microsecond buckets: bucket 0 holds samples
+// under 1 us, bucket i holds [2^(i-1), 2^i) us, and the last bucket everything above ~1 s.
+// Recording is a couple of integer ops, so it can sit on hot interactive paths.
+class LatencyHistogram
+{
+public:
+    static constexpr int kBuckets = 22;
+
+    void record(qint64 nsecs);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 maxNsecs() const { return m_maxNsecs; }
+    double meanMicros() const { return m_count ? m_totalNsecs / 1000.0 / m_count : 0.0; }
+    // Upper bound of the bucket holding the given percentile (0-100), in microseconds
+    qint64 percentileMicros(double percentile) const;
+
+    // One line for the log, e.g. "n=42 mean=180.5us p50<=256us p99<=1024us max=900.1us"
+    QString summary() const;
+
+private:
+    std::array<quint64, kBuckets> m_buckets{};
+    quint64 m_count = 0;
+    qint64 m_totalNsecs = 0;
+    qint64 m_maxNsecs = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -7,6 +7,8 @@
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
+    QApplication::setOrganizationName("UtiliSOFT"); // Settings and local data live under this name
+    QApplication::setApplicationName("utilisoft");
     app.setWindowIcon(QIcon("C:/Users/EYAD/Documents/dbms-har/dbms/images/icon.png"));
     MainWindow w;
     w.setWindowTitle("  UtiliSOFT");
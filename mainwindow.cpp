@@ -9,10 +9,20 @@
 #include "salesmanager.h"
 #include "salesdashboard.h"
 #include "saleitem.h"
+#include "cartmodel.h"
+#include "cartdelegate.h"
+#include "rowbuffermodel.h"
+#include "refreshscheduler.h"
+#include "searchcontroller.h"
 
 #include <QDebug>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QProgressDialog>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QDateEdit>
 #include <QColor>
 #include <QRegularExpression>
 #include <QStyleFactory>
@@ -23,6 +33,12 @@
 #include <QEasingCurve>
 #include <optional>
 #include <QtCharts>
+#include <QShortcut>
+#include <QElapsedTimer>
+#include <QInputDialog>
+#include <limits>
+#include <QStatusBar>
+#include <QLabel>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -36,9 +52,20 @@ MainWindow::MainWindow(QWidget *parent)
     , m_stockManager(nullptr)
     , m_salesManager(nullptr)
     , m_salesdashboard(nullptr)
+    , m_refreshScheduler(nullptr)
+    , m_searchController(nullptr)
+    , m_debtorModel(nullptr)
+    , m_productModel(nullptr)
+    , m_workerProductModel(nullptr)
+    , m_vendorModel(nullptr)
+    , m_workerModel(nullptr)
+    , m_stockModel(nullptr)
+    , m_workerStockModel(nullptr)
+    , m_salesModel(nullptr)
+    , m_productSalesModel(nullptr)
     , isDarkMode(true)
     , passwordVisible(false)
-    , m_totalAmount(0.0)
+    , m_cartModel(nullptr)
     , m_currentSelectedRow(-1)
     , m_salesChart(nullptr)
     , m_salesSeries(nullptr)
@@ -82,10 +109,17 @@ MainWindow::MainWindow(QWidget *parent)
     setupWorkerManager();
     setupStockManager();
     initializeSalesSystem(); // This creates SalesDashboard and SalesManager
+    setupRefreshScheduler(); // Needs every manager and model above
+    setupSearch();
+
+    // Runtime counters of the caches, schedulers and search; anywhere in the window
+    auto *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::showDiagnostics);
 
     setupChart(); // Sets up the sales chart
     setupCalculator();
     setupNavigation(); // This should be called AFTER SalesDashboard is potentially added to stackedWidget
+    connect(m_dbHandler->counters(), &DashboardCounters::countersChanged, this, &MainWindow::updateDashboardCounters);
     updateDashboard(); // Initial dashboard update
 }
 
@@ -196,7 +230,7 @@ QString MainWindow::processStyleSheetForLightMode(const QString &styleSheet) {
     return result;
 }
 
-void MainWindow::applyLightModeToTable(QTableWidget* table) {
+void MainWindow::applyLightModeToTable(QTableView* table) {
     if (!table) return;
     // Store original settings if not already done (simplified here)
     // if (!originalTableSettings.contains(table)) { /* ... */ }
@@ -220,16 +254,16 @@ void MainWindow::applyLightModeToTable(QTableWidget* table) {
     table->setGridStyle(Qt::SolidLine);
     table->setAlternatingRowColors(true);
 
-    QString tableStyle = "QTableWidget {"
+    QString tableStyle = "QTableView {"
                          "    gridline-color: #e2e8f0;"
                          "    background-color: white;"
                          "    selection-background-color: #bfdbfe;" // Light blue selection
                          "    selection-color: #1e3a8a;"           // Dark blue text for selection
                          "    border: 1px solid #cbd5e1; border-radius: 4px;"
                          "}"
-                         "QTableWidget::item { padding: 4px; border-bottom: 1px solid #f1f5f9; color: #334155; }" // Dark text for items
-                         "QTableWidget::item:selected { background-color: #bfdbfe; color: #1e3a8a; }"
-                         "QTableWidget::item:alternate { background-color: #f8fafc; }"; // Very light alternate rows
+                         "QTableView::item { padding: 4px; border-bottom: 1px solid #f1f5f9; color: #334155; }" // Dark text for items
+                         "QTableView::item:selected { background-color: #bfdbfe; color: #1e3a8a; }"
+                         "QTableView::item:alternate { background-color: #f8fafc; }"; // Very light alternate rows
     table->setStyleSheet(tableStyle);
 }
 
@@ -241,7 +275,7 @@ void MainWindow::applyLightModeToAllWidgets() {
     for (QWidget* widget : allWidgets) {
         originalStylesheets[widget] = widget->styleSheet(); // Store original
         widget->setStyleSheet(processStyleSheetForLightMode(widget->styleSheet()));
-        if (QTableWidget* table = qobject_cast<QTableWidget*>(widget)) {
+        if (QTableView* table = qobject_cast<QTableView*>(widget)) {
             applyLightModeToTable(table);
         }
         // Add specific styling for other widget types if needed
@@ -275,7 +309,7 @@ void MainWindow::restoreDarkModeToAllWidgets() {
 
     // Restore table styles (simplified - ideally revert to original QPalette or detailed settings)
     for (auto it = originalTableSettings.begin(); it != originalTableSettings.end(); ++it) {
-        QTableWidget* table = it.key();
+        QTableView* table = it.key();
         if (!table) continue;
         // This is a simplified restoration; ideally, you'd restore all QPalette aspects
         // or revert to the stylesheet stored in originalStylesheets[table]
@@ -419,36 +453,29 @@ void MainWindow::setupChart() {
     }
 }
 
-void MainWindow::updateSalesChart() {
-    if (!m_salesSeries || !m_dbHandler || !m_dbHandler->isConnected() || !m_salesChart) {
+void MainWindow::updateSalesChart(const QVector<QPair<QDate, double>> &dailySales) {
+    if (!m_salesSeries || !m_salesChart) {
         qDebug() << "Sales chart update prerequisites not met.";
         return;
     }
 
     m_salesSeries->clear();
-    QSqlQuery query(m_dbHandler->getDatabase());
-    query.prepare("SELECT DATE(sale_date), SUM(total_price) FROM Sales GROUP BY DATE(sale_date) ORDER BY DATE(sale_date) ASC LIMIT 30");
 
     double maxSalesValue = 0.0;
     QDateTime minDataDate;
     QDateTime maxDataDate;
     bool dataFound = false;
 
-    if (query.exec()) {
-        while (query.next()) {
-            dataFound = true;
-            QDate dateOnly = query.value(0).toDate();
-            QDateTime dateTime = dateOnly.startOfDay(); // Use QDateTime for the axis
-            double totalSales = query.value(1).toDouble();
+    for (const auto &day : dailySales) {
+        dataFound = true;
+        QDateTime dateTime = day.first.startOfDay(); // Use QDateTime for the axis
+        double totalSales = day.second;
 
-            m_salesSeries->append(dateTime.toMSecsSinceEpoch(), totalSales);
+        m_salesSeries->append(dateTime.toMSecsSinceEpoch(), totalSales);
 
-            if (totalSales > maxSalesValue) maxSalesValue = totalSales;
-            if (minDataDate.isNull() || dateTime < minDataDate) minDataDate = dateTime;
-            if (maxDataDate.isNull() || dateTime > maxDataDate) maxDataDate = dateTime;
-        }
-    } else {
-        qDebug() << "Failed to fetch sales data for chart:" << query.lastError().text();
+        if (totalSales > maxSalesValue) maxSalesValue = totalSales;
+        if (minDataDate.isNull() || dateTime < minDataDate) minDataDate = dateTime;
+        if (maxDataDate.isNull() || dateTime > maxDataDate) maxDataDate = dateTime;
     }
 
     QList<QAbstractAxis*> axesXList = m_salesChart->axes(Qt::Horizontal, m_salesSeries);
@@ -610,6 +637,9 @@ void MainWindow::on_loginbtn_clicked() {
 
     if (m_dbHandler->login(username, password)) {
         ui->stackedWidget->setCurrentIndex(m_dbHandler->isAdmin() ? 1 : 8); // Admin or Worker dashboard
+        if (m_stockManager) m_stockManager->ensureStockSummary(); // Seeds ProductStock on first run
+        if (m_salesManager) m_salesManager->ensureSalesRollup(); // Same for the SalesDaily chart rollup
+        m_dbHandler->productIndex()->build();
         updateDashboard(); // Update dashboard after
     } else {
         QMessageBox::warning(this, "Login Failed", "Invalid username or password. Please try again.");
@@ -617,6 +647,7 @@ void MainWindow::on_loginbtn_clicked() {
 }
 
 void MainWindow::logoutUser() {
+    if (m_salesManager) m_salesManager->scanLatency().reset(); // Diagnostics cover one session
     if (m_dbHandler) m_dbHandler->logout();
     if(ui->username_login) ui->username_login->clear();
     if(ui->password_login) ui->password_login->clear();
@@ -637,27 +668,33 @@ void MainWindow::on_eyeButton_clicked() {
 void MainWindow::setupDebtManager() {
     m_debtManager = new DebtManager(m_dbHandler, this);
     connect(m_debtManager, &DebtManager::debtorsUpdated, this, &MainWindow::onDebtorsUpdated);
-    if(ui->debtorsTable) setupTableWidget(ui->debtorsTable, {"ID", "Name", "Contact", "Address", "Amount", "Date"});
+    m_debtorModel = DebtManager::createModel({"ID", "Name", "Contact", "Address", "Amount", "Date"}, this);
+    setupTableView(ui->debtorsTable, m_debtorModel);
     refreshDebtorTable();
 }
 void MainWindow::setupProductManager() {
     m_productManager = new ProductManager(m_dbHandler, this);
     connect(m_productManager, &ProductManager::productsUpdated, this, &MainWindow::onProductsUpdated);
-    if(ui->productsTable) setupTableWidget(ui->productsTable, {"ID", "Name", "Price", "Category", "Quantity", "Added At"});
-    if(ui->productsTable_2) setupTableWidget(ui->productsTable_2, {"ID", "Name", "Price", "Category", "Quantity", "Added At"}); // For worker product view
+    connect(m_productManager, &ProductManager::productsUpdated, m_dbHandler->productIndex(), &ProductIndex::rebuild);
+    m_productModel = ProductManager::createModel({"ID", "Name", "Price", "Category", "Quantity", "Added At"}, this);
+    m_workerProductModel = ProductManager::createModel({"ID", "Name", "Price", "Category", "Quantity", "Added At"}, this); // For worker product view
+    setupTableView(ui->productsTable, m_productModel);
+    setupTableView(ui->productsTable_2, m_workerProductModel);
     refreshProductTable();
     if(ui->categoryCombo) ui->categoryCombo->addItems({"Electronics", "Clothing", "Food", "Beverages", "Household", "Other"});
 }
 void MainWindow::setupVendorManager() {
     m_vendorManager = new VendorManager(m_dbHandler, this);
     connect(m_vendorManager, &VendorManager::vendorsUpdated, this, &MainWindow::onVendorsUpdated);
-    if(ui->vendorsTable) setupTableHeaders(ui->vendorsTable, {"ID", "Name", "Contact", "Address", "Payment", "Date of Supply"});
+    m_vendorModel = VendorManager::createModel({"ID", "Name", "Contact", "Address", "Payment", "Date of Supply"}, this);
+    setupTableView(ui->vendorsTable, m_vendorModel);
     refreshVendorTable();
 }
 void MainWindow::setupWorkerManager() {
     m_workManager = new WorkerManager(m_dbHandler, this);
     connect(m_workManager, &WorkerManager::workersUpdated, this, &MainWindow::onWorkersUpdated);
-    if(ui->workersTable) setupTableHeaders(ui->workersTable, {"ID", "Name", "Contact", "Email", "Status", "Salary", "Date of Joining"});
+    m_workerModel = WorkerManager::createModel({"ID", "Name", "Contact", "Email", "Status", "Salary", "Date of Joining"}, this);
+    setupTableView(ui->workersTable, m_workerModel);
     refreshWorkerTable();
     if(ui->statusCombo) {
         ui->statusCombo->clear(); // Ensure it's empty before adding
@@ -668,82 +705,175 @@ void MainWindow::setupStockManager() {
     m_stockManager = new StockManager(m_dbHandler, this);
     connect(m_stockManager, &StockManager::stockUpdated, this, &MainWindow::onStockUpdated);
     QStringList headers = {"Product ID", "Product Name", "Price/Unit", "Category","Total Quantity", "Remaining Quantity"};
-    if(ui->stockTable) setupTableHeaders(ui->stockTable, headers);
-    if(ui->workerStockTable) setupTableHeaders(ui->workerStockTable, headers);
+    m_stockModel = StockManager::createModel(headers, this);
+    m_workerStockModel = StockManager::createModel(headers, this);
+    setupTableView(ui->stockTable, m_stockModel);
+    setupTableView(ui->workerStockTable, m_workerStockModel);
+
+    // Recovery command on the admin stock page: verify the ProductStock summary and offer a rebuild
+    if (ui->stockTable) {
+        auto *verifyShortcut = new QShortcut(QKeySequence("Ctrl+Shift+R"), ui->stockTable->parentWidget());
+        verifyShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        connect(verifyShortcut, &QShortcut::activated, this, &MainWindow::verifyStockSummary);
+    }
     refreshStockTable();
 }
 
-// --- Table Setup ---
-void MainWindow::setupTableWidget(QTableWidget *table, const QStringList &headers) {
-    if (!table) { qDebug() << "setupTableWidget: table is null"; return; }
-    table->setColumnCount(headers.size());
-    table->setHorizontalHeaderLabels(headers);
-    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    table->setSelectionBehavior(QAbstractItemView::SelectRows);
-    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    table->verticalHeader()->setVisible(false);
-    table->setAlternatingRowColors(true);
+void MainWindow::showDiagnostics() {
+    QStringList lines;
+    if (m_refreshScheduler) {
+        lines << QString("Refreshes: %1 requested, %2 run, %3 coalesced")
+                     .arg(m_refreshScheduler->requestedCount()).arg(m_refreshScheduler->runCount())
+                     .arg(m_refreshScheduler->coalescedCount());
+    }
+    if (m_searchController) {
+        lines << QString("Search: %1 keystrokes, %2 queries, %3 cancelled, %4 stale")
+                     .arg(m_searchController->keystrokes()).arg(m_searchController->queriesIssued())
+                     .arg(m_searchController->queriesCancelled()).arg(m_searchController->staleResults());
+    }
+    if (m_salesManager) {
+        const LatencyHistogram &scans = m_salesManager->scanLatency();
+        lines << "Scan to cart: " + (scans.count() > 0 ? scans.summary() : QString("no scans yet"));
+        lines << QString("Sale journal: %1 pending%2").arg(m_salesManager->journalPending())
+                     .arg(m_salesManager->isOffline() ? ", selling offline" : "");
+    }
+    if (m_dbHandler) {
+        const StatementCache *cache = m_dbHandler->statementCache();
+        lines << QString("Statement cache: %1 hits, %2 misses").arg(cache->hits()).arg(cache->misses());
+        const ProductIndex *index = m_dbHandler->productIndex();
+        lines << QString("Product index: %1 products, %2 lookups, %3 us average").arg(index->size())
+                     .arg(index->lookups())
+                     .arg(index->lookups() > 0 ? index->lookupNsecs() / 1000.0 / index->lookups() : 0.0, 0, 'f', 1);
+    }
+    QMessageBox::information(this, "Diagnostics", lines.join("\n"));
 }
-void MainWindow::setupTableHeaders(QTableWidget *table, const QStringList &headers) {
-    // This is identical to setupTableWidget; can be consolidated if desired.
-    setupTableWidget(table, headers);
+
+void MainWindow::verifyStockSummary() {
+    if (!m_stockManager || !m_dbHandler || !m_dbHandler->isConnected()) return;
+
+    const int mismatches = m_stockManager->verifyStockSummary();
+    if (mismatches < 0) {
+        showDarkMessageBox("Error", "Could not verify the stock summary.");
+    } else if (mismatches == 0) {
+        QMessageBox::information(this, "Stock Summary", "Stock summary matches products and sales.");
+    } else if (QMessageBox::question(this, "Stock Summary",
+                                     QString("%1 stock summary rows are out of date. Rebuild now?").arg(mismatches))
+               == QMessageBox::Yes) {
+        if (!m_stockManager->rebuildStockSummary()) showDarkMessageBox("Error", "Failed to rebuild the stock summary.");
+    }
+}
+
+// --- Table Setup ---
+void MainWindow::setupTableView(QTableView *view, RowBufferModel *model) {
+    if (!view) { qDebug() << "setupTableView: view is null"; return; }
+    view->setModel(model);
+    view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->verticalHeader()->setVisible(false);
+    view->setAlternatingRowColors(true);
 }
 
 // --- Refresh Functions ---
-void MainWindow::refreshDebtorTable() { if (m_debtManager && m_dbHandler && m_dbHandler->isConnected() && ui->debtorsTable) m_debtManager->loadDebtors(ui->debtorsTable); }
+void MainWindow::refreshDebtorTable() { if (m_debtManager && m_dbHandler && m_dbHandler->isConnected()) m_debtManager->loadDebtors(m_debtorModel); }
 void MainWindow::refreshProductTable() {
     if (m_productManager && m_dbHandler && m_dbHandler->isConnected()) {
-        if(ui->productsTable) m_productManager->loadProducts(ui->productsTable);
-        if(ui->productsTable_2) m_productManager->loadProducts(ui->productsTable_2);
+        m_productManager->loadProducts(m_productModel);
+        m_productManager->loadProducts(m_workerProductModel);
     }
 }
-void MainWindow::refreshVendorTable() { if (m_vendorManager && m_dbHandler && m_dbHandler->isConnected() && ui->vendorsTable) m_vendorManager->loadVendors(ui->vendorsTable); }
-void MainWindow::refreshWorkerTable() { if (m_workManager && m_dbHandler && m_dbHandler->isConnected() && ui->workersTable) m_workManager->loadWorkers(ui->workersTable); }
+void MainWindow::refreshVendorTable() { if (m_vendorManager && m_dbHandler && m_dbHandler->isConnected()) m_vendorManager->loadVendors(m_vendorModel); }
+void MainWindow::refreshWorkerTable() { if (m_workManager && m_dbHandler && m_dbHandler->isConnected()) m_workManager->loadWorkers(m_workerModel); }
 void MainWindow::refreshStockTable() {
     if (m_stockManager && m_dbHandler && m_dbHandler->isConnected()) {
-        if(ui->stockTable) m_stockManager->loadStock(ui->stockTable);
-        if(ui->workerStockTable) m_stockManager->loadStock(ui->workerStockTable);
+        m_stockManager->loadStock(m_stockModel);
+        m_stockManager->loadStock(m_workerStockModel);
     }
 }
 
 // --- Update Handlers (Slots) ---
-void MainWindow::onDebtorsUpdated() { refreshDebtorTable(); updateDashboard(); }
-void MainWindow::onProductsUpdated() { refreshProductTable(); updateDashboard(); refreshProductSalesTable(); /* Sales dashboard might need this */ }
-void MainWindow::onVendorsUpdated() { refreshVendorTable(); updateDashboard(); }
-void MainWindow::onWorkersUpdated() { refreshWorkerTable(); updateDashboard(); }
-void MainWindow::onStockUpdated() { refreshStockTable(); updateDashboard(); refreshProductSalesTable(); /* Sales depends on product stock */}
+// Dashboard labels follow DashboardCounters::countersChanged, so these only mark what to reload.
+// The scheduler runs each marked reload once when control returns to the event loop.
+void MainWindow::onDebtorsUpdated() { m_refreshScheduler->markDirty(RefreshScheduler::Debtors); }
+void MainWindow::onProductsUpdated() {
+    // ProductStock rows come and go with products, and the sales picker lists products
+    m_refreshScheduler->markDirty(RefreshScheduler::Products | RefreshScheduler::Stock | RefreshScheduler::ProductSales);
+}
+void MainWindow::onVendorsUpdated() { m_refreshScheduler->markDirty(RefreshScheduler::Vendors); }
+void MainWindow::onWorkersUpdated() { m_refreshScheduler->markDirty(RefreshScheduler::Workers); }
+void MainWindow::onStockUpdated() { m_refreshScheduler->markDirty(RefreshScheduler::Stock | RefreshScheduler::ProductSales); }
 void MainWindow::onSalesUpdated() {
-    refreshSalesTable();            // Sales history table
-    refreshProductSalesTable();     // Product list for new sales (stock updated)
-    refreshStockTable();            // General stock views
-    updateDashboard();              // Main dashboard stats and chart
-    if (m_salesdashboard) m_salesdashboard->refreshData(); // The dedicated SalesDashboard widget
+    // New history rows, stock left, picker stock counts, the chart and the SalesDashboard views
+    m_refreshScheduler->markDirty(RefreshScheduler::NewSales | RefreshScheduler::ProductSales
+                                  | RefreshScheduler::Stock | RefreshScheduler::SalesChart
+                                  | RefreshScheduler::DashboardSales);
+}
+
+void MainWindow::setupSearch() {
+    // Every search edit goes through one debounced, cancellable front end
+    m_searchController = new SearchController(m_dbHandler, 250, this);
+    auto attach = [this](QLineEdit *edit, quint64 (MainWindow::*search)(const QString &)) {
+        m_searchController->attach(edit, [this, search](const QString &text) { return (this->*search)(text); });
+    };
+    attach(ui->debtorSearchEdit, &MainWindow::searchDebtors);
+    attach(ui->productSearchEdit, &MainWindow::searchProducts);
+    attach(ui->workerProductSearchEdit, &MainWindow::searchWorkerProducts);
+    attach(ui->vendorSearchEdit, &MainWindow::searchVendors);
+    attach(ui->workerSearchEdit, &MainWindow::searchWorkers);
+    attach(ui->viewStockSearchEdit, &MainWindow::searchStock);
+    attach(ui->workerStockSearchEdit, &MainWindow::searchWorkerStock);
+    attach(ui->productSalesSearchEdit_2, &MainWindow::searchProductSales);
+    attach(ui->salesSearchEdit, &MainWindow::searchSalesHistory);
+}
+
+void MainWindow::setupRefreshScheduler() {
+    m_refreshScheduler = new RefreshScheduler(this);
+    m_refreshScheduler->setHandler(RefreshScheduler::Debtors, [this]() { refreshDebtorTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::Products, [this]() { refreshProductTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::Vendors, [this]() { refreshVendorTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::Workers, [this]() { refreshWorkerTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::Stock, [this]() { refreshStockTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::ProductSales, [this]() { refreshProductSalesTable(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::NewSales, [this]() {
+        if (m_salesManager) m_salesManager->loadNewSales(m_salesModel); // Prepend only the new rows
+    });
+    m_refreshScheduler->setHandler(RefreshScheduler::SalesChart, [this]() { updateDashboard(); });
+    m_refreshScheduler->setHandler(RefreshScheduler::DashboardSales, [this]() {
+        if (m_salesdashboard) m_salesdashboard->refreshAfterSale();
+    });
 }
 
 void MainWindow::updateDashboard() {
     if (!m_dbHandler || !m_dbHandler->isConnected()) return;
-    int totalDebtors = 0; double totalDebt = 0.0;
-    if (m_debtManager && m_debtManager->getDebtorStats(totalDebtors, totalDebt)) {
-        if(ui->labelTotalDebtors) ui->labelTotalDebtors->setText(QString::number(totalDebtors));
-        if(ui->workerLabelTotalDebt) ui->labelTotalDebt->setText(QString("%1 Rs.").arg(totalDebt, 0, 'f', 2));
-        if(ui->workerTotalDebtorsLabel) ui->workerTotalDebtorsLabel->setText(QString::number(totalDebtors));
-        if(ui->workerLabelTotalDebt) ui->workerLabelTotalDebt->setText(QString("%1 Rs.").arg(totalDebt, 0, 'f', 2));
-    }
-    int totalProducts = 0; int totalStock = 0;
-    if (m_productManager && m_productManager->getProductStats(totalProducts, totalStock)) {
-        if(ui->labelTotalProducts) ui->labelTotalProducts->setText(QString::number(totalProducts));
-        if(ui->workerTotalProductsLabel) ui->workerTotalProductsLabel->setText(QString::number(totalProducts));
-        // Update labelTotalStock if you have one
-    }
-    int numSales = 0; double totalSalesAmount = 0.0; double profit = 0.0; // Assuming profit is calculated by SalesManager
-    if (m_salesManager && m_salesManager->getSalesStats(numSales, totalSalesAmount, profit)) {
-        if(ui->labelTotalSales) ui->labelTotalSales->setText(QString::number(numSales));
-        if(ui->labelTotalAmount) ui->labelTotalAmount->setText(QString("%1 Rs.").arg(totalSalesAmount, 0, 'f', 2));
-        if(ui->workerTotalAmountLabel) ui->workerTotalAmountLabel->setText(QString("%1 Rs.").arg(totalSalesAmount, 0, 'f', 2));
-        if(ui->workerTotalSalesLabel) ui->workerTotalSalesLabel->setText(QString::number(numSales));
-        // Update profit label if you have one
-    }
-    updateSalesChart(); // Refresh the chart with new data
+
+    updateDashboardCounters();
+
+    // The chart reads a primary-key range of the SalesDaily rollup
+    QVector<QPair<QDate, double>> dailySales;
+    if (m_salesManager && m_salesManager->getDailySales(dailySales, 30)) {
+        updateSalesChart(dailySales); // Refresh the chart with new data
+    }
+}
+
+void MainWindow::updateDashboardCounters() {
+    // Served from the in-process counters cache; manager mutations keep it current
+    if (!m_dbHandler || !m_dbHandler->counters()->isSeeded()) return;
+    const DashboardTotals totals = m_dbHandler->counters()->totals();
+
+    if(ui->labelTotalDebtors) ui->labelTotalDebtors->setText(QString::number(totals.debtors));
+    if(ui->workerLabelTotalDebt) ui->labelTotalDebt->setText(QString("%1 Rs.").arg(totals.debt, 0, 'f', 2));
+    if(ui->workerTotalDebtorsLabel) ui->workerTotalDebtorsLabel->setText(QString::number(totals.debtors));
+    if(ui->workerLabelTotalDebt) ui->workerLabelTotalDebt->setText(QString("%1 Rs.").arg(totals.debt, 0, 'f', 2));
+
+    if(ui->labelTotalProducts) ui->labelTotalProducts->setText(QString::number(totals.products));
+    if(ui->workerTotalProductsLabel) ui->workerTotalProductsLabel->setText(QString::number(totals.products));
+    // Update labelTotalStock if you have one
+
+    if(ui->labelTotalSales) ui->labelTotalSales->setText(QString::number(totals.sales));
+    if(ui->labelTotalAmount) ui->labelTotalAmount->setText(QString("%1 Rs.").arg(totals.salesAmount, 0, 'f', 2));
+    if(ui->workerTotalAmountLabel) ui->workerTotalAmountLabel->setText(QString("%1 Rs.").arg(totals.salesAmount, 0, 'f', 2));
+    if(ui->workerTotalSalesLabel) ui->workerTotalSalesLabel->setText(QString::number(totals.sales));
 }
 
 // --- Form/Input Helpers ---
@@ -833,7 +963,7 @@ void MainWindow::on_removeDebtorBtn_clicked() {
     if(!m_debtManager || !ui->debtorsTable) return;
     auto idOpt = getSelectedId(ui->debtorsTable, "debtor");
     if (!idOpt) return;
-    QString name = ui->debtorsTable->item(ui->debtorsTable->currentRow(), 1)->text(); // Assuming name is in column 1
+    QString name = selectedText(ui->debtorsTable, DebtorsTable::Name);
     if (confirmRemoval("debtor", name)) {
         if (m_debtManager->removeDebtor(*idOpt)) {
             showSuccess("Debtor removed successfully.");
@@ -842,20 +972,20 @@ void MainWindow::on_removeDebtorBtn_clicked() {
         }
     }
 }
-void MainWindow::on_debtorSearchEdit_textChanged(const QString &searchText) {
-    if (m_debtManager && m_dbHandler && m_dbHandler->isConnected() && ui->debtorsTable) {
-        if (searchText.isEmpty()) refreshDebtorTable();
-        else m_debtManager->searchDebtors(ui->debtorsTable, searchText);
-    }
+quint64 MainWindow::searchDebtors(const QString &searchText) {
+    if (!m_debtManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { refreshDebtorTable(); return 0; }
+    return m_debtManager->searchDebtors(m_debtorModel, searchText);
 }
 
 // --- Product Management Slots & Helpers ---
-std::tuple<QString, double, QString, int, QDate> MainWindow::getProductFormData() {
+std::tuple<QString, double, QString, int, QDate, QString> MainWindow::getProductFormData() {
     return {ui->productNameEdit ? ui->productNameEdit->text().trimmed() : "",
             ui->priceEdit ? ui->priceEdit->text().toDouble() : 0.0,
             ui->categoryCombo ? ui->categoryCombo->currentText() : "",
             ui->quantityEdit ? ui->quantityEdit->text().toInt() : 0,
-            ui->dateEdit_2 ? ui->dateEdit_2->date() : QDate::currentDate()};
+            ui->dateEdit_2 ? ui->dateEdit_2->date() : QDate::currentDate(),
+            ui->skuEdit ? ui->skuEdit->text().trimmed() : ""};
 }
 bool MainWindow::validateProductInput(const QString &name, double price, int quantity) {
     if (name.isEmpty() || price <= 0 || quantity < 0) {
@@ -863,7 +993,7 @@ bool MainWindow::validateProductInput(const QString &name, double price, int qua
     } return true;
 }
 void MainWindow::clearProductForm() {
-    clearForm({ui->productNameEdit, ui->priceEdit, ui->quantityEdit});
+    clearForm({ui->productNameEdit, ui->priceEdit, ui->quantityEdit, ui->skuEdit});
     if(ui->categoryCombo) ui->categoryCombo->setCurrentIndex(0);
     if(ui->dateEdit_2) ui->dateEdit_2->setDate(QDate::currentDate());
 }
@@ -871,9 +1001,9 @@ void MainWindow::on_addProductBtn_clicked() { clearProductForm(); if(ui->stacked
 void MainWindow::on_addProductBtn_4_clicked() { clearProductForm(); if(ui->stackedWidget) ui->stackedWidget->setCurrentIndex(14); } // Another button for add product page
 void MainWindow::on_addProductBtn_2_clicked() { // Submit product form
     if(!m_productManager) return;
-    auto [name, price, category, quantity, date] = getProductFormData();
+    auto [name, price, category, quantity, date, sku] = getProductFormData();
     if (!validateProductInput(name, price, quantity)) return;
-    if (m_productManager->addProduct(name, price, category, quantity, date)) {
+    if (m_productManager->addProduct(name, price, category, quantity, date, sku)) {
         showSuccessWithOk("Product added successfully!"); // Returns to previous screen on OK
         clearProductForm();
         if(ui->stackedWidget) ui->stackedWidget->setCurrentIndex(3); // Product list page
@@ -883,7 +1013,7 @@ void MainWindow::on_removeProductBtn_clicked() {
     if(!m_productManager || !ui->productsTable) return;
     auto idOpt = getSelectedId(ui->productsTable, "product");
     if (!idOpt) return;
-    QString name = ui->productsTable->item(ui->productsTable->currentRow(), 1)->text();
+    QString name = selectedText(ui->productsTable, ProductsTable::Name);
     if (confirmRemoval("product", name)) {
         if (m_productManager->removeProduct(*idOpt)) {
             showSuccess("Product removed successfully.");
@@ -892,17 +1022,44 @@ void MainWindow::on_removeProductBtn_clicked() {
         }
     }
 }
-void MainWindow::on_productSearchEdit_textChanged(const QString &searchText) { // Admin product search
-    if (m_productManager && m_dbHandler && m_dbHandler->isConnected() && ui->productsTable) {
-        if (searchText.isEmpty()) refreshProductTable(); // Refreshes both admin and worker tables
-        else m_productManager->searchProducts(ui->productsTable, searchText);
-    }
+void MainWindow::on_importProductsBtn_clicked() {
+    if(!m_productManager) return;
+    const QString path = QFileDialog::getOpenFileName(this, "Import Products", QString(), "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty()) return;
+    if (!m_productManager->importProducts(path)) { showError("An import is already running, or the database is not connected."); return; }
+
+    // Progress is in per-mille of the file read; the dialog is the context, so its connections go with it
+    auto *progress = new QProgressDialog("Importing products...", "Cancel", 0, 1000, this);
+    progress->setWindowTitle("Import Products");
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    connect(progress, &QProgressDialog::canceled, m_productManager, &ProductManager::cancelImport);
+    connect(m_productManager, &ProductManager::importProgress, progress,
+            [progress](qint64 bytesRead, qint64 totalBytes, int imported, int rejected) {
+        progress->setValue(totalBytes > 0 ? int(bytesRead * 1000 / totalBytes) : 0);
+        progress->setLabelText(QString("Imported %1 products, rejected %2 rows...").arg(imported).arg(rejected));
+    });
+    connect(m_productManager, &ProductManager::importFinished, progress, [this, progress](const ImportReport &report) {
+        progress->close();
+        QString summary = QString("Imported %1 products in %2 s.").arg(report.imported).arg(report.elapsedMs / 1000.0, 0, 'f', 1);
+        if (report.cancelled) summary += "\nThe import was cancelled; the rows before that point were kept.";
+        if (report.rejected > 0) summary += QString("\n%1 rows were rejected and written to:\n%2").arg(report.rejected).arg(report.rejectsPath);
+        if (!report.error.isEmpty()) showError(summary + "\n\nThe import stopped: " + report.error);
+        else showSuccess(summary);
+    });
+    progress->show();
 }
-void MainWindow::on_workerProductSearchEdit_textChanged(const QString &searchText){ // Worker product search (usually on productsTable_2)
-    if (m_productManager && m_dbHandler && m_dbHandler->isConnected() && ui->productsTable_2) {
-        if(searchText.isEmpty()) m_productManager->loadProducts(ui->productsTable_2); // Or call refreshProductTable
-        else m_productManager->searchProducts(ui->productsTable_2, searchText);
-    }
+quint64 MainWindow::searchProducts(const QString &searchText) { // Admin product search
+    if (!m_productManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { refreshProductTable(); return 0; } // Refreshes both admin and worker tables
+    return m_productManager->searchProducts(m_productModel, searchText);
+}
+quint64 MainWindow::searchWorkerProducts(const QString &searchText) { // Worker product search (usually on productsTable_2)
+    if (!m_productManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { m_productManager->loadProducts(m_workerProductModel); return 0; }
+    return m_productManager->searchProducts(m_workerProductModel, searchText);
 }
 
 // --- Vendor Management Slots & Helpers ---
@@ -932,7 +1089,7 @@ void MainWindow::on_removeVendorBtn_clicked() {
     if(!m_vendorManager || !ui->vendorsTable) return;
     auto idOpt = getSelectedId(ui->vendorsTable, "vendor");
     if (!idOpt) return;
-    QString name = ui->vendorsTable->item(ui->vendorsTable->currentRow(), 1)->text();
+    QString name = selectedText(ui->vendorsTable, VendorsTable::Name);
     if (confirmRemoval("vendor", name)) {
         if (m_vendorManager->removeVendor(*idOpt)) {
             showDarkMessageBox("Success", "Vendor removed successfully!");
@@ -941,11 +1098,10 @@ void MainWindow::on_removeVendorBtn_clicked() {
         }
     }
 }
-void MainWindow::on_vendorSearchEdit_textChanged(const QString &searchText) {
-    if (m_vendorManager && m_dbHandler && m_dbHandler->isConnected() && ui->vendorsTable) {
-        if (searchText.isEmpty()) refreshVendorTable();
-        else m_vendorManager->searchVendors(ui->vendorsTable, searchText);
-    }
+quint64 MainWindow::searchVendors(const QString &searchText) {
+    if (!m_vendorManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { refreshVendorTable(); return 0; }
+    return m_vendorManager->searchVendors(m_vendorModel, searchText);
 }
 
 // --- Worker Management Slots & Helpers ---
@@ -977,7 +1133,7 @@ void MainWindow::on_removeWorkerBtn_clicked() {
     if(!m_workManager || !ui->workersTable) return;
     auto idOpt = getSelectedId(ui->workersTable, "worker");
     if (!idOpt) return;
-    QString name = ui->workersTable->item(ui->workersTable->currentRow(), 1)->text();
+    QString name = selectedText(ui->workersTable, WorkersTable::Name);
     if (confirmRemoval("worker", name)) {
         if (m_workManager->removeWorker(*idOpt)) {
             showDarkMessageBox("Success", "Worker removed successfully!");
@@ -986,36 +1142,34 @@ void MainWindow::on_removeWorkerBtn_clicked() {
         }
     }
 }
-void MainWindow::on_workerSearchEdit_textChanged(const QString &searchText) { // Admin worker search
-    if (m_workManager && m_dbHandler && m_dbHandler->isConnected() && ui->workersTable) {
-        if(searchText.isEmpty()) refreshWorkerTable();
-        else m_workManager->searchWorkers(ui->workersTable, searchText);
-    }
+quint64 MainWindow::searchWorkers(const QString &searchText) { // Admin worker search
+    if (!m_workManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { refreshWorkerTable(); return 0; }
+    return m_workManager->searchWorkers(m_workerModel, searchText);
 }
 
 // --- Stock Management Slots ---
-void MainWindow::on_viewStockSearchEdit_textChanged(const QString &searchText) { // Admin stock search
-    if (m_stockManager && m_dbHandler && m_dbHandler->isConnected() && ui->stockTable) {
-        if(searchText.isEmpty()) refreshStockTable(); // Refreshes both admin and worker stock tables
-        else m_stockManager->searchStock(ui->stockTable, searchText);
-    }
+quint64 MainWindow::searchStock(const QString &searchText) { // Admin stock search
+    if (!m_stockManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { refreshStockTable(); return 0; } // Refreshes both admin and worker stock tables
+    return m_stockManager->searchStock(m_stockModel, searchText);
 }
-void MainWindow::on_workerStockSearchEdit_textChanged(const QString &searchText) { // Worker stock search
-    if (m_stockManager && m_dbHandler && m_dbHandler->isConnected() && ui->workerStockTable) {
-        if(searchText.isEmpty()) m_stockManager->loadStock(ui->workerStockTable); // Or call refreshStockTable
-        else m_stockManager->searchStock(ui->workerStockTable, searchText);
-    }
+quint64 MainWindow::searchWorkerStock(const QString &searchText) { // Worker stock search
+    if (!m_stockManager || !m_dbHandler || !m_dbHandler->isConnected()) return 0;
+    if (searchText.isEmpty()) { m_stockManager->loadStock(m_workerStockModel); return 0; }
+    return m_stockManager->searchStock(m_workerStockModel, searchText);
 }
 
-std::optional<int> MainWindow::getSelectedId(QTableWidget *table, const QString &type)
+std::optional<int> MainWindow::getSelectedId(QTableView *table, const QString &type)
 {
-    if (!table || table->selectedItems().isEmpty()) {
+    if (!table || !table->selectionModel() || !table->selectionModel()->hasSelection()) {
         showDarkMessageBox("Error", QString("Please select a %1 to remove!").arg(type));
         return std::nullopt;
     }
 
-    bool ok;
-    int id = table->item(table->selectedItems().first()->row(), 0)->text().toInt(&ok);
+    bool ok = false;
+    const QModelIndexList rows = table->selectionModel()->selectedRows(0);
+    int id = rows.isEmpty() ? 0 : rows.first().data(Qt::UserRole).toInt(&ok);
 
     if (!ok) {
         showDarkMessageBox("Error", QString("Invalid %1 ID!").arg(type));
@@ -1024,22 +1178,43 @@ std::optional<int> MainWindow::getSelectedId(QTableWidget *table, const QString
 
     return id;
 }
+
+QString MainWindow::selectedText(QTableView *table, int column) const
+{
+    if (!table || !table->selectionModel()) return QString();
+    const QModelIndexList rows = table->selectionModel()->selectedRows(column);
+    return rows.isEmpty() ? QString() : rows.first().data().toString();
+}
+
 void MainWindow::setupSalesManager()
 {
     m_salesManager = new SalesManager(m_dbHandler, this);
 
     // Initialize member variables
-    m_selectedItems.clear();
-    m_totalAmount = 0.0;
     m_currentSelectedRow = -1;
 
     // Connect signals
     connect(m_salesManager, &SalesManager::salesUpdated, this, &MainWindow::onSalesUpdated);
+    // The cashier sees when the till is selling offline and how much is still to be sent
+    auto *journalLabel = new QLabel(this);
+    journalLabel->setStyleSheet("color: #e67e22; font-weight: bold;");
+    statusBar()->addPermanentWidget(journalLabel);
+    auto showPending = [journalLabel](int pending) {
+        journalLabel->setText(QString("Offline: %1 sale(s) waiting to sync").arg(pending));
+        journalLabel->setVisible(pending > 0);
+    };
+    connect(m_salesManager, &SalesManager::journalChanged, journalLabel, showPending);
+    showPending(m_salesManager->journalPending());
+    connect(m_salesManager, &SalesManager::journalConflicts, this, [this](const QStringList &messages) {
+        QMessageBox::warning(this, "Offline Sales", messages.join("\n\n"));
+    });
 
     // Setup tables with proper headers
-    setupSalesTable(ui->searchProductTable, {"ID", "Name", "Price", "Category", "Stock", "Updated"}, 6);
-    setupSalesTable(ui->selectedProductsTable, {"Product", "Price", "Qty", "Total", "Remove"}, 5);
-    setupSalesTable(ui->salesTable, {"Sales ID", "Salesman ID", "Product ID", "Product Name", "Price", "Category", "Quantity Sold", "Date/Time"}, 8);
+    m_productSalesModel = ProductManager::createModel({"ID", "Name", "Price", "Category", "Stock", "Updated"}, this);
+    m_salesModel = m_salesManager->createSalesModel({"Sales ID", "Salesman ID", "Product ID", "Product Name", "Price", "Category", "Quantity Sold", "Date/Time"}, this);
+    setupTableView(ui->searchProductTable, m_productSalesModel);
+    setupCartTable();
+    setupTableView(ui->salesTable, m_salesModel);
 
     // Connect UI signals
 
@@ -1049,14 +1224,22 @@ void MainWindow::setupSalesManager()
     refreshSalesTable();
 }
 
-void MainWindow::setupSalesTable(QTableWidget *table, const QStringList &headers, int columnCount)
+void MainWindow::setupCartTable()
 {
+    m_cartModel = new CartModel(this);
+    connect(m_cartModel, &CartModel::totalChanged, this, &MainWindow::updateSalesTotals);
+    QTableView *table = ui->selectedProductsTable;
     if (!table) return;
 
-    table->setColumnCount(columnCount);
-    table->setHorizontalHeaderLabels(headers);
+    auto *delegate = new CartDelegate(table);
+    // Queued: the line is removed after the view has finished handling the click
+    connect(delegate, &CartDelegate::removeClicked, this, &MainWindow::removeCartLine, Qt::QueuedConnection);
+    table->setModel(m_cartModel);
+    table->setItemDelegate(delegate);
+    table->setMouseTracking(true); // Hover state for the remove button
     table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
     table->setEditTriggers(QAbstractItemView::NoEditTriggers);
     table->verticalHeader()->setVisible(false);
     table->setAlternatingRowColors(true);
@@ -1064,17 +1247,15 @@ void MainWindow::setupSalesTable(QTableWidget *table, const QStringList &headers
 
 void MainWindow::connectSalesSignals()
 {
-    // Search functionality
-    connect(ui->productSalesSearchEdit_2, &QLineEdit::textChanged,
-            this, &MainWindow::on_productSalesSearchEdit_textChanged);
-    connect(ui->salesSearchEdit, &QLineEdit::textChanged,
-            this, &MainWindow::on_salesSearchEdit_textChanged);
+    // Search edits are attached to m_searchController in setupSearch(); Enter tries the text as a barcode
+    connect(ui->productSalesSearchEdit_2, &QLineEdit::returnPressed,
+            this, &MainWindow::onProductCodeScanned);
 
     // Table interactions
-    connect(ui->searchProductTable, &QTableWidget::cellClicked,
-            this, &MainWindow::on_searchProductTable_cellClicked);
-    connect(ui->selectedProductsTable, &QTableWidget::cellClicked,
-            this, &MainWindow::on_selectedProductsTable_cellClicked);
+    connect(ui->searchProductTable, &QTableView::clicked,
+            this, &MainWindow::on_searchProductTable_clicked);
+    connect(ui->selectedProductsTable, &QTableView::clicked,
+            this, &MainWindow::onCartLineClicked);
 
     // Quantity controls
 
@@ -1121,64 +1302,22 @@ void MainWindow::showSalesDashboard()
 // Refresh methods
 void MainWindow::refreshSalesTable()
 {
-    if (m_salesManager && ui->salesTable) {
-        m_salesManager->loadSales(ui->salesTable);
+    if (m_salesManager) {
+        m_salesManager->loadSales(m_salesModel);
     }
 }
 
 void MainWindow::refreshProductSalesTable()
 {
-    if (m_productManager && ui->searchProductTable) {
-        m_productManager->loadProducts(ui->searchProductTable);
-    }
-}
-
-void MainWindow::refreshSelectedProductsTable()
-{
-    if (!ui->selectedProductsTable) return;
-
-    ui->selectedProductsTable->setRowCount(0);
-
-    for (int i = 0; i < m_selectedItems.size(); i++) {
-        const SaleItem &item = m_selectedItems[i];
-        int row = ui->selectedProductsTable->rowCount();
-        ui->selectedProductsTable->insertRow(row);
-
-        // Set item data
-        ui->selectedProductsTable->setItem(row, 0, new QTableWidgetItem(item.productName));
-        ui->selectedProductsTable->setItem(row, 1, new QTableWidgetItem(QString::number(item.unitPrice, 'f', 2)));
-        ui->selectedProductsTable->setItem(row, 2, new QTableWidgetItem(QString::number(item.quantity)));
-        ui->selectedProductsTable->setItem(row, 3, new QTableWidgetItem(QString::number(item.totalPrice, 'f', 2)));
-
-        // Create remove button
-        auto *removeBtn = new QPushButton("×", this);
-        removeBtn->setStyleSheet("background-color: #e74c3c; color: white; font-weight: bold; padding: 5px;");
-        removeBtn->setCursor(Qt::PointingHandCursor);
-
-        // Connect with proper index capture
-        connect(removeBtn, &QPushButton::clicked, [this, i]() {
-            if (i < m_selectedItems.size()) {
-                m_selectedItems.removeAt(i);
-                refreshSelectedProductsTable();
-                updateSalesTotals();
-            }
-        });
-
-        ui->selectedProductsTable->setCellWidget(row, 4, removeBtn);
+    if (m_productManager) {
+        m_productManager->loadProducts(m_productSalesModel);
     }
-
-    updateSalesTotals();
 }
 
-void MainWindow::updateSalesTotals()
+void MainWindow::updateSalesTotals(double total)
 {
-    m_totalAmount = 0.0;
-    for (const SaleItem &item : m_selectedItems) {
-        m_totalAmount += item.totalPrice;
-    }
-
     if (ui->labelTotalPrice) {
-        ui->labelTotalPrice->setText(QString("%1 Rs.").arg(m_totalAmount, 0, 'f', 2));
+        ui->labelTotalPrice->setText(QString("%1 Rs.").arg(total, 0, 'f', 2));
     }
 }
 
@@ -1191,98 +1330,184 @@ void MainWindow::addProductToSelection(const SaleItem &item)
         return;
     }
 
-    // Check if product already exists in selection
-    for (int i = 0; i < m_selectedItems.size(); i++) {
-        if (m_selectedItems[i].productId == item.productId) {
-            auto &existingItem = m_selectedItems[i];
-            if (existingItem.quantity < existingItem.available) {
-                existingItem.quantity++;
-                existingItem.totalPrice = existingItem.quantity * existingItem.unitPrice;
-                refreshSelectedProductsTable();
-                highlightSelectedProduct(i);
-            } else {
-                QMessageBox::warning(this, "Insufficient Stock",
-                                     "Cannot add more of this product. Stock limit reached.");
-            }
-            return;
+    // A product already in the cart gets one more unit instead of a second line
+    const int row = m_cartModel->indexOf(item.productId);
+    if (row >= 0) {
+        if (m_cartModel->setQuantity(row, m_cartModel->items().at(row).quantity + 1)) {
+            highlightSelectedProduct(row);
+        } else {
+            QMessageBox::warning(this, "Insufficient Stock",
+                                 "Cannot add more of this product. Stock limit reached.");
         }
+        return;
     }
 
-    // Add new product
-    m_selectedItems.append(item);
-    refreshSelectedProductsTable();
-    highlightSelectedProduct(m_selectedItems.size() - 1);
+    m_cartModel->append(item);
+    highlightSelectedProduct(m_cartModel->rowCount() - 1);
 }
 
-void MainWindow::highlightSelectedProduct(int row)
+void MainWindow::removeCartLine(int row)
 {
-    if (!ui->selectedProductsTable) return;
-
-    // Clear all highlights first
-    for (int i = 0; i < ui->selectedProductsTable->rowCount(); i++) {
-        for (int j = 0; j < ui->selectedProductsTable->columnCount(); j++) {
-            auto *item = ui->selectedProductsTable->item(i, j);
-            if (item) {
-                item->setBackground(i == row ? QColor("#436cfd") : Qt::transparent);
-            }
-        }
+    m_cartModel->removeAt(row);
+    if (m_currentSelectedRow == row) {
+        m_currentSelectedRow = -1;
+    } else if (m_currentSelectedRow > row) {
+        m_currentSelectedRow--;
     }
+}
 
+void MainWindow::highlightSelectedProduct(int row)
+{
+    if (ui->selectedProductsTable) ui->selectedProductsTable->selectRow(row);
     m_currentSelectedRow = row;
 }
 
 // Slot implementations
-void MainWindow::on_productSalesSearchEdit_textChanged(const QString &text)
+quint64 MainWindow::searchProductSales(const QString &text)
 {
-    if (!m_productManager || !ui->searchProductTable) return;
+    if (!m_productManager) return 0;
 
     if (text.isEmpty()) {
         refreshProductSalesTable();
-    } else {
-        m_productManager->searchProducts(ui->searchProductTable, text);
+        return 0;
+    }
+    return m_productManager->searchProducts(m_productSalesModel, text);
+}
+
+quint64 MainWindow::searchSalesHistory(const QString &text)
+{
+    if (!m_salesManager) return 0;
+
+    return m_salesManager->searchSales(m_salesModel, text);
+}
+
+void MainWindow::on_exportSalesBtn_clicked()
+{
+    if (!m_salesManager) return;
+
+    QDialog rangeDialog(this);
+    rangeDialog.setWindowTitle("Export Sales");
+    auto *form = new QFormLayout(&rangeDialog);
+    auto *fromEdit = new QDateEdit(QDate(QDate::currentDate().year(), QDate::currentDate().month(), 1), &rangeDialog);
+    auto *toEdit = new QDateEdit(QDate::currentDate(), &rangeDialog);
+    for (QDateEdit *edit : {fromEdit, toEdit}) {
+        edit->setCalendarPopup(true);
+        edit->setDisplayFormat("yyyy-MM-dd");
+    }
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &rangeDialog);
+    connect(buttons, &QDialogButtonBox::accepted, &rangeDialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &rangeDialog, &QDialog::reject);
+    form->addRow("From", fromEdit);
+    form->addRow("To", toEdit);
+    form->addRow(buttons);
+    if (rangeDialog.exec() != QDialog::Accepted) return;
+    const QDate from = fromEdit->date();
+    const QDate to = toEdit->date();
+    if (from > to) { showWarning("The start date must not be after the end date."); return; }
+
+    const QString suggested = QString("sales_%1_%2.csv").arg(from.toString("yyyyMMdd"), to.toString("yyyyMMdd"));
+    const QString path = QFileDialog::getSaveFileName(this, "Export Sales", suggested, "CSV files (*.csv)");
+    if (path.isEmpty()) return;
+    if (!m_salesManager->exportSales(path, from, to)) { showError("An export is already running, or the database is not connected."); return; }
+
+    // Same pattern as the product import: the dialog is the context of its connections
+    auto *progress = new QProgressDialog("Exporting sales...", "Cancel", 0, 1000, this);
+    progress->setWindowTitle("Export Sales");
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    connect(progress, &QProgressDialog::canceled, m_salesManager, &SalesManager::cancelExport);
+    connect(m_salesManager, &SalesManager::exportProgress, progress, [progress](qint64 rowsWritten, qint64 totalRows) {
+        progress->setValue(totalRows > 0 ? int(qMin(rowsWritten, totalRows) * 1000 / totalRows) : 1000);
+        progress->setLabelText(QString("Exported %1 of %2 sales lines...").arg(rowsWritten).arg(totalRows));
+    });
+    connect(m_salesManager, &SalesManager::exportFinished, progress, [this, progress](const ExportReport &report) {
+        progress->close();
+        if (!report.error.isEmpty()) showError("The export failed: " + report.error);
+        else if (report.cancelled) showWarning("The export was cancelled; no file was written.");
+        else showSuccess(QString("Exported %1 sales lines in %2 s to:\n%3")
+                             .arg(report.rows).arg(report.elapsedMs / 1000.0, 0, 'f', 1).arg(report.path));
+    });
+    progress->show();
+}
+
+void MainWindow::on_receiptLookupBtn_clicked()
+{
+    if (!m_salesManager) return;
+
+    // The number the sale confirmation showed; one header row and its lines
+    bool ok = false;
+    const int orderId = QInputDialog::getInt(this, "Find Receipt", "Receipt number:", 1, 1,
+                                             std::numeric_limits<int>::max(), 1, &ok);
+    if (!ok) return;
+
+    SaleOrder order;
+    QList<SaleItem> lines;
+    if (!m_salesManager->getReceipt(orderId, order, lines)) { showWarning(QString("Receipt #%1 was not found.").arg(orderId)); return; }
+
+    QStringList text{QString("Receipt #%1, %2, salesman %3")
+                         .arg(order.orderId).arg(order.orderDate.toString("yyyy-MM-dd hh:mm")).arg(order.salesmanId), QString()};
+    for (const SaleItem &line : lines) {
+        text << QString("%1  x%2 @ %3 = %4 Rs.").arg(line.productName).arg(line.quantity)
+                    .arg(line.unitPrice, 0, 'f', 2).arg(line.totalPrice, 0, 'f', 2);
     }
+    text << QString() << QString("Total: %1 Rs. (%2 lines, %3 units)")
+                             .arg(order.totalAmount, 0, 'f', 2).arg(order.itemCount).arg(order.unitCount);
+    QMessageBox::information(this, "Receipt", text.join("\n"));
 }
 
-void MainWindow::on_salesSearchEdit_textChanged(const QString &text)
+void MainWindow::onProductCodeScanned()
 {
-    if (!m_salesManager || !ui->salesTable) return;
+    if (!m_salesManager || !ui->productSalesSearchEdit_2) return;
+
+    QElapsedTimer timer;
+    timer.start();
 
-    m_salesManager->searchSales(ui->salesTable, text);
+    // Text that isn't a known SKU / barcode stays an ordinary search
+    SaleItem item;
+    if (!m_salesManager->lookupCode(ui->productSalesSearchEdit_2->text(), item)) return;
+
+    if (item.available <= 0) {
+        QMessageBox::warning(this, "Out of Stock",
+                             QString("Product '%1' is currently out of stock.").arg(item.productName));
+        return;
+    }
+
+    addProductToSelection(item);
+    m_salesManager->scanLatency().record(timer.nsecsElapsed());
+    ui->productSalesSearchEdit_2->clear(); // Ready for the next scan
 }
 
-void MainWindow::on_searchProductTable_cellClicked(int row, int column)
+void MainWindow::on_searchProductTable_clicked(const QModelIndex &index)
 {
-    if (!ui->searchProductTable || row < 0 || row >= ui->searchProductTable->rowCount()) return;
+    if (!m_productSalesModel || !index.isValid() || index.row() >= m_productSalesModel->rowCount()) return;
 
-    // Extract product data from table
+    // Extract product data from the model's typed buffers
+    const int row = index.row();
     SaleItem item;
-    item.productId = ui->searchProductTable->item(row, 0)->text().toInt();
-    item.productName = ui->searchProductTable->item(row, 1)->text();
-    item.unitPrice = ui->searchProductTable->item(row, 2)->text().toDouble();
-    item.category = ui->searchProductTable->item(row, 3)->text();
-    item.available = ui->searchProductTable->item(row, 4)->text().toInt();
+    item.productId = static_cast<int>(m_productSalesModel->intValue(row, 0));
+    item.productName = m_productSalesModel->text(row, 1);
+    item.unitPrice = m_productSalesModel->realValue(row, 2);
+    item.category = m_productSalesModel->text(row, 3);
+    item.available = static_cast<int>(m_productSalesModel->intValue(row, 4));
     item.quantity = 1;
     item.totalPrice = item.unitPrice;
 
     addProductToSelection(item);
 }
 
-void MainWindow::on_selectedProductsTable_cellClicked(int row, int column)
+void MainWindow::onCartLineClicked(const QModelIndex &index)
 {
-    highlightSelectedProduct(row);
+    if (index.isValid()) highlightSelectedProduct(index.row());
 }
 
 void MainWindow::on_addQtyBtn_clicked()
 {
-    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_selectedItems.size()) {
-        auto &item = m_selectedItems[m_currentSelectedRow];
-
-        if (item.quantity < item.available) {
-            item.quantity++;
-            item.totalPrice = item.quantity * item.unitPrice;
-            refreshSelectedProductsTable();
-            highlightSelectedProduct(m_currentSelectedRow);
-        } else {
+    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_cartModel->rowCount()) {
+        const SaleItem &item = m_cartModel->items().at(m_currentSelectedRow);
+
+        if (!m_cartModel->setQuantity(m_currentSelectedRow, item.quantity + 1)) {
             QMessageBox::warning(this, "Insufficient Stock",
                                  "Cannot add more of this product. Stock limit reached.");
         }
@@ -1292,21 +1517,15 @@ void MainWindow::on_addQtyBtn_clicked()
 
 void MainWindow::on_removeQtyBtn_clicked()
 {
-    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_selectedItems.size()) {
-        auto &item = m_selectedItems[m_currentSelectedRow];
-
-        if (item.quantity > 1) {
-            item.quantity--;
-            item.totalPrice = item.quantity * item.unitPrice;
-            refreshSelectedProductsTable();
-            highlightSelectedProduct(m_currentSelectedRow);
-        }
+    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_cartModel->rowCount()) {
+        const SaleItem &item = m_cartModel->items().at(m_currentSelectedRow);
+        m_cartModel->setQuantity(m_currentSelectedRow, item.quantity - 1); // Refused below one
     }
 }
 
 void MainWindow::on_sellProductsBtn_clicked()
 {
-    if (m_selectedItems.isEmpty()) {
+    if (m_cartModel->isEmpty()) {
         QMessageBox::warning(this, "No Products Selected",
                              "Please select at least one product to complete the sale.");
         return;
@@ -1325,20 +1544,21 @@ void MainWindow::on_sellProductsBtn_clicked()
         return;
     }
 
-    // Process the sale
-    if (m_salesManager->processSale(m_selectedItems, userId)) {
+    // Process the sale; stock is checked atomically by the decrement itself
+    QList<StockShortage> shortages;
+    int orderId = 0;
+    if (m_salesManager->processSale(m_cartModel->items(), userId, &shortages, &orderId)) {
         QMessageBox::information(this, "Sale Completed",
-                                 QString("Sale of %1 items totaling %2 Rs. has been successfully recorded.")
-                                     .arg(m_selectedItems.size())
-                                     .arg(m_totalAmount, 0, 'f', 2));
+                                 QString("Sale of %1 items totaling %2 Rs. has been successfully recorded.%3")
+                                     .arg(m_cartModel->rowCount())
+                                     .arg(m_cartModel->total(), 0, 'f', 2)
+                                     .arg(orderId > 0 ? QString("\nReceipt #%1").arg(orderId) : QString()));
 
         // Clear selection after successful sale
-        m_selectedItems.clear();
-        m_currentSelectedRow = -1;
-        refreshSelectedProductsTable();
-        refreshSalesTable();
-        refreshProductSalesTable(); // Refresh to show updated stock
-        updateDashboard(); // Update main dashboard
+        m_cartModel->clear();
+        m_currentSelectedRow = -1; // History, stock and dashboard follow from salesUpdated
+    } else if (!shortages.isEmpty()) {
+        QMessageBox::warning(this, "Insufficient Stock", SalesManager::describeShortages(shortages));
     } else {
         QMessageBox::critical(this, "Sale Failed",
                               "There was an error processing the sale. Please try again.");
@@ -1347,16 +1567,15 @@ void MainWindow::on_sellProductsBtn_clicked()
 
 void MainWindow::on_clearSelectionBtn_clicked()
 {
-    if (m_selectedItems.isEmpty()) return;
+    if (m_cartModel->isEmpty()) return;
 
     auto reply = QMessageBox::question(this, "Clear Selection",
                                        "Are you sure you want to clear all selected products?",
                                        QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        m_selectedItems.clear();
+        m_cartModel->clear();
         m_currentSelectedRow = -1;
-        refreshSelectedProductsTable();
     }
 }
 
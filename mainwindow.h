@@ -9,6 +9,7 @@
 #include <QValueAxis>
 #include <QtSql>
 #include <QTableWidget>
+#include <QTableView>
 #include <QLabel>
 #include <QPushButton>
 #include <QMap>
@@ -29,6 +30,11 @@ class WorkerManager;
 class SalesManager;
 class SalesDashboard;
 class StockManager;
+class RowBufferModel;
+class SalesHistoryModel;
+class RefreshScheduler;
+class SearchController;
+class CartModel;
 struct SaleItem;
 
 class MainWindow : public QMainWindow
@@ -50,49 +56,49 @@ private slots:
     void on_addDebtorBtn_clicked();
     void on_addDebtorBtn_2_clicked();
     void on_removeDebtorBtn_clicked();
-    void on_debtorSearchEdit_textChanged(const QString &searchText);
     void onDebtorsUpdated();
 
     void on_addProductBtn_clicked();
     void on_addProductBtn_4_clicked();
     void on_addProductBtn_2_clicked();
     void on_removeProductBtn_clicked();
-    void on_productSearchEdit_textChanged(const QString &searchText);
-    void on_workerProductSearchEdit_textChanged(const QString &searchText);
+    void on_importProductsBtn_clicked();
     void onProductsUpdated();
 
     void on_addVendorBtn_clicked();
     void on_addVendorBtn_2_clicked();
     void on_removeVendorBtn_clicked();
-    void on_vendorSearchEdit_textChanged(const QString &searchText);
     void onVendorsUpdated();
 
     void on_addWorkerBtn_clicked();
     void on_addWorkerBtn_2_clicked();
     void on_removeWorkerBtn_clicked();
-    void on_workerSearchEdit_textChanged(const QString &searchText);
     void onWorkersUpdated();
 
-    void on_viewStockSearchEdit_textChanged(const QString &searchText);
-    void on_workerStockSearchEdit_textChanged(const QString &searchText);
     void onStockUpdated();
+    void verifyStockSummary();
 
-    void on_productSalesSearchEdit_textChanged(const QString &searchText);
-    void on_salesSearchEdit_textChanged(const QString &searchText);
-    void on_searchProductTable_cellClicked(int row, int column);
-    void on_selectedProductsTable_cellClicked(int row, int column);
+    void on_searchProductTable_clicked(const QModelIndex &index);
+    void onProductCodeScanned();
+    void onCartLineClicked(const QModelIndex &index);
+    void removeCartLine(int row);
+    void updateSalesTotals(double total);
     void on_addQtyBtn_clicked();
     void on_removeQtyBtn_clicked();
     void on_sellProductsBtn_clicked();
     void on_clearSelectionBtn_clicked();
+    void on_exportSalesBtn_clicked();
+    void on_receiptLookupBtn_clicked();
     void onSalesUpdated();
 
     void updateDashboard();
+    void updateDashboardCounters();
     void on_cross_2_clicked();
+    void showDiagnostics();
 
 private:
     void setupChart();
-    void updateSalesChart();
+    void updateSalesChart(const QVector<QPair<QDate, double>> &dailySales);
     void setupCalculator();
     void setupNavigation();
     void connectPageButton(QPushButton *button, int pageIndex);
@@ -102,6 +108,8 @@ private:
     void setupVendorManager();
     void setupWorkerManager();
     void setupStockManager();
+    void setupRefreshScheduler();
+    void setupSearch();
     void setupSalesManager();
     void integrateSalesDashboard();
     bool initializeSalesSystem();
@@ -111,15 +119,14 @@ private:
     QString applyLightModeColor(const QString &originalColor);
     QColor stringToColor(const QString &colorStr);
     QString colorToString(const QColor &color, const QString &originalFormat);
-    void applyLightModeToTable(QTableWidget* table);
+    void applyLightModeToTable(QTableView* table);
     void applyLightModeToAllWidgets();
     void restoreDarkModeToAllWidgets();
 
     void logoutUser();
 
-    void setupTableWidget(QTableWidget *table, const QStringList &headers);
-    void setupTableHeaders(QTableWidget *table, const QStringList &headers);
-    void setupSalesTable(QTableWidget *table, const QStringList &headers, int columnCount);
+    void setupCartTable();
+    void setupTableView(QTableView *view, RowBufferModel *model);
 
     void refreshDebtorTable();
     void refreshProductTable();
@@ -128,7 +135,7 @@ private:
     void refreshStockTable();
 
     std::tuple<QString, QString, QString, double, QDate> getDebtorFormData();
-    std::tuple<QString, double, QString, int, QDate> getProductFormData();
+    std::tuple<QString, double, QString, int, QDate, QString> getProductFormData();
     bool validateDebtorInput(const QString &name, const QString &contact, const QString &address, double amount);
     bool validateProductInput(const QString &name, double price, int quantity);
     void clearDebtorForm();
@@ -137,7 +144,8 @@ private:
     void clearForm(const QList<QLineEdit*> &fields);
     std::tuple<QString, QString, QString, QString> getFormData(const QList<QLineEdit*> &fields);
     bool validateInput(const QStringList &fields);
-    std::optional<int> getSelectedId(QTableWidget *table, const QString &type);
+    std::optional<int> getSelectedId(QTableView *table, const QString &type);
+    QString selectedText(QTableView *table, int column) const;
 
     void showDarkMessageBox(const QString &title, const QString &message);
     bool confirmRemoval(const QString &type, const QString &name);
@@ -148,8 +156,17 @@ private:
 
     void refreshSalesTable();
     void refreshProductSalesTable();
-    void refreshSelectedProductsTable();
-    void updateSalesTotals();
+    // Search handlers driven by m_searchController; each returns the worker request id (0 if none)
+    quint64 searchDebtors(const QString &searchText);
+    quint64 searchProducts(const QString &searchText);
+    quint64 searchWorkerProducts(const QString &searchText);
+    quint64 searchVendors(const QString &searchText);
+    quint64 searchWorkers(const QString &searchText);
+    quint64 searchStock(const QString &searchText);
+    quint64 searchWorkerStock(const QString &searchText);
+    quint64 searchProductSales(const QString &searchText);
+    quint64 searchSalesHistory(const QString &searchText);
+
     void addProductToSelection(const SaleItem &item);
     void highlightSelectedProduct(int rowInSelectedTable);
 
@@ -162,6 +179,19 @@ private:
     StockManager *m_stockManager;
     SalesManager *m_salesManager;
     SalesDashboard *m_salesdashboard;
+    RefreshScheduler *m_refreshScheduler;
+    SearchController *m_searchController;
+
+    // Row-buffer models behind the ui table views
+    RowBufferModel *m_debtorModel;
+    RowBufferModel *m_productModel;
+    RowBufferModel *m_workerProductModel;
+    RowBufferModel *m_vendorModel;
+    RowBufferModel *m_workerModel;
+    RowBufferModel *m_stockModel;
+    RowBufferModel *m_workerStockModel;
+    SalesHistoryModel *m_salesModel;
+    RowBufferModel *m_productSalesModel;
 
     bool isDarkMode;
     bool passwordVisible;
@@ -176,10 +206,9 @@ private:
         QMap<QPair<int, int>, QBrush> itemBackgrounds;
         QMap<QPair<int, int>, QBrush> itemForegrounds;
     };
-    QMap<QTableWidget*, TableSettings> originalTableSettings;
+    QMap<QTableView*, TableSettings> originalTableSettings;
 
-    QList<SaleItem> m_selectedItems;
-    double m_totalAmount;
+    CartModel *m_cartModel; // Lines of the sale being rung up
     int m_currentSelectedRow;
 
     QChart *m_salesChart;
@@ -0,0 +1,42 @@
+#include "modelloader.h"
+#include "databasehandler.h"
+#include <QDebug>
+
+ModelLoader::ModelLoader(DatabaseHandler *dbHandler, const QString &what, QObject *parent)
+    : QObject(parent)
+    , m_dbHandler(dbHandler)
+    , m_what(what)
+{
+    connect(m_dbHandler->worker(), &DatabaseWorker::queryFinished, this, &ModelLoader::onQueryFinished);
+}
+
+quint64 ModelLoader::submit(RowBufferModel *model, const QString &sql, const QVariantList &params,
+                            DatabaseWorker::Priority priority)
+{
+    if (!model) return 0;
+    if (!m_dbHandler->isConnected()) {
+        qDebug() << "Database not connected";
+        return 0;
+    }
+
+    const quint64 requestId = m_dbHandler->worker()->submit(sql, params, priority);
+    m_pendingModels.insert(requestId, model);
+    m_latestRequest.insert(model, requestId);
+    return requestId;
+}
+
+void ModelLoader::onQueryFinished(quint64 requestId, const DbResult &result)
+{
+    if (!m_pendingModels.contains(requestId)) return; // Not one of ours
+
+    QPointer<RowBufferModel> model = m_pendingModels.take(requestId);
+    if (!model || m_latestRequest.value(model) != requestId) return; // Superseded
+
+    m_latestRequest.remove(model);
+    if (result.cancelled) return;
+    if (!result.ok) {
+        qDebug() << "Failed to load" << m_what << ":" << result.error;
+        return;
+    }
+    model->setRows(result);
+}
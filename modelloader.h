@@ -0,0 +1,36 @@
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include "databaseworker.h"
+#include "rowbuffermodel.h"
+
+class DatabaseHandler;
+
+// Runs a manager's SELECTs on the database worker and fills the target model when the rows
+// arrive. Only the newest request per model is applied; superseded or cancelled results are
+// dropped on arrival, so a slow early query can never overwrite a later one.
+class ModelLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModelLoader(DatabaseHandler *dbHandler, const QString &what, QObject *parent = nullptr);
+
+    // Returns the worker request id, or 0 if nothing was submitted (e.g. not connected)
+    quint64 submit(RowBufferModel *model, const QString &sql, const QVariantList &params,
+                   DatabaseWorker::Priority priority);
+
+private slots:
+    void onQueryFinished(quint64 requestId, const DbResult &result);
+
+private:
+    DatabaseHandler *m_dbHandler;
+    QString m_what; // For log messages, e.g. "stock"
+    QHash<quint64, QPointer<RowBufferModel>> m_pendingModels;
+    QHash<RowBufferModel*, quint64> m_latestRequest;
+};
+
+#endif // MODELLOADER_H
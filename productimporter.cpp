@@ -0,0 +1,421 @@
+#include "productimporter.h"
+#include "connectionpool.h"
+#include "sqldialect.h"
+#include <QFile>
+#include <QDate>
+#include <QSet>
+#include <QVector>
+#include <QLocale>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+
+namespace {
+const int kChunkRows = 5000;          // Rows per transaction
+const int kMaxRowsPerStatement = 500; // Rows per multi-row INSERT, before the dialect's bind limit
+const int kProductColumns = 6;
+
+// Streams records out of an RFC 4180 CSV file a buffer at a time. Quoted fields may contain
+// commas, doubled quotes and line breaks; LF or CRLF ends a record. Delimiters are ASCII, so
+// fields are split on bytes and decoded from UTF-8 only once complete.
+class CsvReader
+{
+public:
+    explicit CsvReader(QIODevice *device) : m_device(device), m_pos(0), m_bytesRead(0), m_line(1), m_recordLine(1) {}
+
+    bool next(QStringList &fields)
+    {
+        fields.clear();
+        m_recordLine = m_line;
+        QByteArray field;
+        bool inQuotes = false;
+        bool started = false;
+        for (;;) {
+            if (m_pos >= m_buffer.size() && !fill()) {
+                if (!started) return false;
+                fields.append(QString::fromUtf8(field));
+                return true;
+            }
+            const char c = m_buffer.at(m_pos++);
+            started = true;
+            if (inQuotes) {
+                if (c != '"') {
+                    if (c == '\n') ++m_line;
+                    field.append(c);
+                } else if ((m_pos < m_buffer.size() || fill()) && m_buffer.at(m_pos) == '"') {
+                    field.append('"'); // Escaped quote
+                    ++m_pos;
+                } else {
+                    inQuotes = false;
+                }
+            } else if (c == ',') {
+                fields.append(QString::fromUtf8(field));
+                field.clear();
+            } else if (c == '\n') {
+                ++m_line;
+                fields.append(QString::fromUtf8(field));
+                return true;
+            } else if (c == '"' && field.isEmpty()) {
+                inQuotes = true;
+            } else if (c != '\r') {
+                field.append(c);
+            }
+        }
+    }
+
+    qint64 bytesRead() const { return m_bytesRead; }
+    qint64 recordLine() const { return m_recordLine; } // Line the last record started on
+
+private:
+    bool fill()
+    {
+        m_buffer = m_device->read(1 << 20);
+        m_pos = 0;
+        if (m_bytesRead == 0 && m_buffer.startsWith("\xEF\xBB\xBF")) m_pos = 3; // UTF-8 BOM
+        m_bytesRead += m_buffer.size();
+        return m_pos < m_buffer.size();
+    }
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    qint64 m_bytesRead;
+    qint64 m_line;
+    qint64 m_recordLine;
+};
+
+struct ColumnMap {
+    int name = -1;
+    int price = -1;
+    int category = -1;
+    int quantity = -1;
+    int sku = -1;
+    int updatedAt = -1;
+    QDate today; // updated_at for rows that don't give one
+};
+
+struct ImportRow {
+    qint64 line = 0;
+    QStringList fields;
+    QString reason; // Empty while the row is valid
+    QString name;
+    QString category;
+    QString sku;
+    double price = 0.0;
+    int quantity = 0;
+    QDate updatedAt;
+};
+
+int findColumn(const QStringList &header, const QStringList &aliases)
+{
+    for (int i = 0; i < header.size(); ++i) {
+        if (aliases.contains(header.at(i).trimmed().toLower())) return i;
+    }
+    return -1;
+}
+
+// Runs on the global thread pool, one call per row
+void validate(const ColumnMap &columns, ImportRow &row)
+{
+    auto field = [&row](int index) {
+        return index >= 0 && index < row.fields.size() ? row.fields.at(index).trimmed() : QString();
+    };
+    const QLocale c = QLocale::c();
+    bool ok = false;
+
+    row.name = field(columns.name);
+    if (row.name.isEmpty() || row.name.size() > 255) {
+        row.reason = row.name.isEmpty() ? "Missing name" : "Name longer than 255 characters";
+        return;
+    }
+    row.price = c.toDouble(field(columns.price), &ok);
+    if (!ok || row.price <= 0 || !qIsFinite(row.price)) {
+        row.reason = "Invalid price";
+        return;
+    }
+    const QString quantity = field(columns.quantity);
+    row.quantity = quantity.isEmpty() ? 0 : c.toInt(quantity, &ok);
+    if ((!quantity.isEmpty() && !ok) || row.quantity < 0) {
+        row.reason = "Invalid quantity";
+        return;
+    }
+    row.category = field(columns.category);
+    if (row.category.size() > 255) {
+        row.reason = "Category longer than 255 characters";
+        return;
+    }
+    row.sku = field(columns.sku);
+    if (row.sku.size() > 64) {
+        row.reason = "SKU longer than 64 characters";
+        return;
+    }
+    const QString updatedAt = field(columns.updatedAt);
+    row.updatedAt = updatedAt.isEmpty() ? columns.today : QDate::fromString(updatedAt, Qt::ISODate);
+    if (!row.updatedAt.isValid()) row.reason = "Invalid date (expected YYYY-MM-DD)";
+}
+
+QByteArray csvField(const QString &text)
+{
+    QByteArray bytes = text.toUtf8();
+    if (bytes.contains(',') || bytes.contains('"') || bytes.contains('\n') || bytes.contains('\r')) {
+        bytes.replace("\"", "\"\"");
+        bytes = '"' + bytes + '"';
+    }
+    return bytes;
+}
+
+// Rejected rows with their source line and reason, ahead of the original fields
+class RejectWriter
+{
+public:
+    RejectWriter(const QString &path, const QStringList &header) : m_file(path), m_header(header)
+    {
+        QFile::remove(path); // Left over from an earlier import of the same file
+    }
+
+    bool write(const ImportRow &row)
+    {
+        if (!m_file.isOpen()) {
+            if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                qDebug() << "Failed to open import rejects:" << m_file.errorString();
+                return false;
+            }
+            writeRecord(QStringList{"line", "reason"} + m_header);
+        }
+        return writeRecord(QStringList{QString::number(row.line), row.reason} + row.fields);
+    }
+
+    QString path() const { return m_file.isOpen() ? m_file.fileName() : QString(); }
+
+private:
+    bool writeRecord(const QStringList &fields)
+    {
+        QByteArray record;
+        for (const QString &field : fields) record.append(csvField(field)).append(',');
+        record.back() = '\n';
+        return m_file.write(record) == record.size();
+    }
+
+    QFile m_file;
+    QStringList m_header;
+};
+}
+
+ProductImporter::ProductImporter(ConnectionPool *pool, const SqlDialect *dialect, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_dialect(dialect)
+    , m_cancelled(false)
+{
+    connect(&m_watcher, &QFutureWatcher<ImportReport>::finished, this, &ProductImporter::onFinished);
+}
+
+ProductImporter::~ProductImporter()
+{
+    m_cancelled = true;
+    m_watcher.waitForFinished(); // The import holds a pooled connection
+}
+
+bool ProductImporter::start(const QString &path)
+{
+    if (m_watcher.isRunning()) return false;
+    m_cancelled = false;
+    m_watcher.setFuture(QtConcurrent::run([this, path]() { return run(path); }));
+    return true;
+}
+
+void ProductImporter::cancel()
+{
+    m_cancelled = true;
+}
+
+void ProductImporter::onFinished()
+{
+    const ImportReport report = m_watcher.result();
+    qDebug() << "Product import:" << report.imported << "imported," << report.rejected << "rejected in"
+             << report.elapsedMs << "ms" << (report.cancelled ? "(cancelled)" : "");
+    emit finished(report);
+}
+
+ImportReport ProductImporter::run(const QString &path)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ImportReport report;
+    auto fail = [&report, &timer](const QString &error) {
+        report.error = error;
+        report.elapsedMs = timer.elapsed();
+        return report;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return fail("Cannot open " + path + ": " + file.errorString());
+    const qint64 totalBytes = file.size();
+    CsvReader reader(&file);
+
+    QStringList header;
+    if (!reader.next(header)) return fail("The file is empty");
+    ColumnMap columns;
+    columns.name = findColumn(header, {"name", "product_name", "product"});
+    columns.price = findColumn(header, {"price", "unit_price"});
+    columns.category = findColumn(header, {"category"});
+    columns.quantity = findColumn(header, {"quantity", "qty", "stock"});
+    columns.sku = findColumn(header, {"sku", "barcode", "code"});
+    columns.updatedAt = findColumn(header, {"updated_at", "date", "date_added"});
+    columns.today = QDate::currentDate();
+    if (columns.name < 0 || columns.price < 0) return fail("The header row needs at least name and price columns");
+
+    PooledConnection connection(m_pool, 10000);
+    if (!connection.isValid()) return fail("No database connection available");
+    QSqlDatabase db = connection.database();
+
+    // SKUs are unique; clashes are rejected up front so a batch doesn't fail on one row
+    QSet<QString> skus;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT sku FROM Products WHERE sku IS NOT NULL")) {
+        return fail("Failed to read existing SKUs: " + query.lastError().text());
+    }
+    while (query.next()) skus.insert(query.value(0).toString().trimmed());
+
+    const int rowsPerStatement = qMax(1, qMin(kMaxRowsPerStatement, m_dialect->maxBindValues() / kProductColumns));
+    auto insertSql = [](int rows) {
+        QStringList values;
+        for (int i = 0; i < rows; ++i) values.append("(?, ?, ?, ?, ?, ?)");
+        return "INSERT INTO Products (product_name, price, category, quantity, updated_at, sku) VALUES "
+               + values.join(", ");
+    };
+    QSqlQuery fullInsert(db); // Prepared once; every full slice reuses it
+    QSqlQuery rowInsert(db);
+    if (!fullInsert.prepare(insertSql(rowsPerStatement)) || !rowInsert.prepare(insertSql(1))) {
+        return fail("Failed to prepare product insert: " + fullInsert.lastError().text());
+    }
+    auto bindRow = [](QSqlQuery &insert, const ImportRow &row) {
+        insert.addBindValue(row.name);
+        insert.addBindValue(row.price);
+        insert.addBindValue(row.category);
+        insert.addBindValue(row.quantity);
+        insert.addBindValue(row.updatedAt);
+        insert.addBindValue(row.sku.isEmpty() ? QVariant() : QVariant(row.sku)); // NULL keeps the unique key free
+    };
+
+    RejectWriter rejects(path + ".rejected.csv", header);
+    auto reject = [&report, &rejects](ImportRow &row, const QString &reason) {
+        row.reason = reason;
+        rejects.write(row);
+        ++report.rejected;
+    };
+
+    // One transaction per chunk: multi-row INSERTs, then the matching ProductStock rows
+    auto writeChunk = [&](QVector<ImportRow *> &rows) -> bool {
+        if (!db.transaction()) {
+            report.error = "Failed to start import transaction: " + db.lastError().text();
+            return false;
+        }
+        QSqlQuery chunkQuery(db);
+        if (!chunkQuery.exec("SELECT COALESCE(MAX(product_id), 0) FROM Products") || !chunkQuery.next()) {
+            report.error = "Failed to read product ids: " + chunkQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+        const QVariant floorId = chunkQuery.value(0);
+
+        int inserted = 0;
+        qint64 stock = 0;
+        for (int first = 0; first < rows.size(); first += rowsPerStatement) {
+            const int count = qMin(rowsPerStatement, int(rows.size()) - first);
+            QSqlQuery tailInsert(db);
+            QSqlQuery *insert = &fullInsert;
+            if (count < rowsPerStatement) {
+                tailInsert.prepare(insertSql(count));
+                insert = &tailInsert;
+            }
+            for (int i = first; i < first + count; ++i) bindRow(*insert, *rows.at(i));
+            if (insert->exec()) {
+                inserted += count;
+                for (int i = first; i < first + count; ++i) stock += rows.at(i)->quantity;
+                continue;
+            }
+            if (!m_dialect->isDuplicateKey(insert->lastError())) {
+                report.error = "Failed to insert products: " + insert->lastError().text();
+                db.rollback();
+                return false;
+            }
+
+            // A SKU taken since the import started; only the failed statement rolled back, so
+            // retry its rows one at a time and reject the clashing ones
+            for (int i = first; i < first + count; ++i) {
+                bindRow(rowInsert, *rows.at(i));
+                if (rowInsert.exec()) {
+                    ++inserted;
+                    stock += rows.at(i)->quantity;
+                } else if (m_dialect->isDuplicateKey(rowInsert.lastError())) {
+                    reject(*rows[i], "SKU already exists");
+                } else {
+                    report.error = "Failed to insert products: " + rowInsert.lastError().text();
+                    db.rollback();
+                    return false;
+                }
+            }
+        }
+
+        // New products without a summary row. The anti-join also skips products another till
+        // added meanwhile, since those commit their summary row in the same transaction.
+        chunkQuery.prepare("INSERT INTO ProductStock (product_id, product_name, price, category, quantity, sold_quantity) "
+                           "SELECT p.product_id, p.product_name, p.price, p.category, p.quantity, 0 "
+                           "FROM Products p LEFT JOIN ProductStock ps ON ps.product_id = p.product_id "
+                           "WHERE p.product_id > ? AND ps.product_id IS NULL");
+        chunkQuery.addBindValue(floorId);
+        if (!chunkQuery.exec()) {
+            report.error = "Failed to add stock summary rows: " + chunkQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+        if (!db.commit()) {
+            report.error = "Failed to commit import chunk: " + db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        report.imported += inserted;
+        report.stockAdded += stock;
+        return true;
+    };
+
+    QVector<ImportRow> chunk;
+    chunk.reserve(kChunkRows);
+    auto flush = [&]() -> bool {
+        QtConcurrent::blockingMap(chunk, [&columns](ImportRow &row) { validate(columns, row); });
+
+        QVector<ImportRow *> valid;
+        valid.reserve(chunk.size());
+        for (ImportRow &row : chunk) {
+            if (row.reason.isEmpty() && !row.sku.isEmpty()) {
+                if (skus.contains(row.sku)) row.reason = "SKU already exists";
+                else skus.insert(row.sku);
+            }
+            if (row.reason.isEmpty()) valid.append(&row);
+            else reject(row, row.reason);
+        }
+        const bool written = valid.isEmpty() || writeChunk(valid);
+        chunk.clear();
+        emit progress(reader.bytesRead(), totalBytes, report.imported, report.rejected);
+        return written;
+    };
+
+    bool ok = true;
+    ImportRow row;
+    while (ok && !m_cancelled && reader.next(row.fields)) {
+        if (row.fields.size() == 1 && row.fields.first().trimmed().isEmpty()) continue; // Blank line
+        row.line = reader.recordLine();
+        chunk.append(row);
+        if (chunk.size() >= kChunkRows) ok = flush();
+    }
+    if (ok && !m_cancelled && !chunk.isEmpty()) flush();
+
+    report.cancelled = m_cancelled;
+    report.rejectsPath = rejects.path();
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
@@ -0,0 +1,56 @@
+#ifndef PRODUCTIMPORTER_H
+#define PRODUCTIMPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QFutureWatcher>
+#include <atomic>
+
+class ConnectionPool;
+class SqlDialect;
+
+struct ImportReport {
+    int imported = 0;
+    int rejected = 0;
+    qint64 stockAdded = 0;
+    qint64 elapsedMs = 0;
+    bool cancelled = false; // Chunks committed before the cancel stay imported
+    QString error;          // Fatal: unreadable file, unusable header, database failure
+    QString rejectsPath;    // CSV of rejected rows with their line and reason, empty if none
+};
+
+// Bulk product import from a CSV file with a header row (name, price, category, quantity and
+// optionally sku and updated_at, in any order). The file is streamed a buffer at a time; each
+// chunk of rows is validated in parallel, then written with multi-row INSERTs in one
+// transaction per chunk, so a large catalog costs a few hundred statements rather than two
+// per product. Runs on a pooled connection off the GUI thread.
+class ProductImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    ProductImporter(ConnectionPool *pool, const SqlDialect *dialect, QObject *parent = nullptr);
+    ~ProductImporter();
+
+    bool start(const QString &path); // False if an import is already running
+    void cancel();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+signals:
+    // Emitted from the import thread once per chunk; connect with the default (queued) type
+    void progress(qint64 bytesRead, qint64 totalBytes, int imported, int rejected);
+    void finished(const ImportReport &report);
+
+private slots:
+    void onFinished();
+
+private:
+    ImportReport run(const QString &path);
+
+    ConnectionPool *m_pool;
+    const SqlDialect *m_dialect;
+    std::atomic_bool m_cancelled;
+    QFutureWatcher<ImportReport> m_watcher;
+};
+
+#endif // PRODUCTIMPORTER_H
@@ -0,0 +1,245 @@
+#include "productindex.h"
+#include "connectionpool.h"
+#include "rowreader.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Lower tiers rank first
+enum MatchTier { NamePrefix, WordPrefix, NameSubstring, CategorySubstring, NearMiss };
+
+int matchTier(const QString &name, const QString &category, const QString &query)
+{
+    if (name.startsWith(query)) return NamePrefix;
+    if (name.contains(QLatin1Char(' ') + query)) return WordPrefix;
+    if (name.contains(query)) return NameSubstring;
+    if (category.contains(query)) return CategorySubstring;
+    return NearMiss;
+}
+}
+
+ProductIndex::ProductIndex(ConnectionPool *pool, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_generation(0)
+    , m_rebuildGeneration(0)
+    , m_rebuildQueued(false)
+    , m_lookups(0)
+    , m_lookupNsecs(0)
+{
+    connect(&m_rebuildWatcher, &QFutureWatcher<Data>::finished, this, &ProductIndex::onRebuildFinished);
+}
+
+ProductIndex::~ProductIndex()
+{
+    m_rebuildWatcher.waitForFinished(); // The load holds a pooled connection
+}
+
+QString ProductIndex::fold(const QString &text)
+{
+    // Compatibility decomposition splits accented letters into base + combining mark
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (!c.isMark()) folded.append(c);
+    }
+    return folded.toCaseFolded().simplified();
+}
+
+quint64 ProductIndex::trigramKey(const QChar *chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+void ProductIndex::addTrigrams(QVector<quint64> &out, const QString &folded)
+{
+    // Padding gives word starts and ends their own trigrams
+    const QString padded = QLatin1Char(' ') + folded + QLatin1Char(' ');
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        out.append(trigramKey(padded.constData() + i));
+    }
+}
+
+ProductIndex::Data ProductIndex::load(ConnectionPool *pool)
+{
+    Data data;
+    PooledConnection connection(pool);
+    if (!connection.isValid()) return data;
+
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT product_id, product_name, price, category, quantity, sku FROM Products")) {
+        qDebug() << "Failed to load product index:" << query.lastError().text();
+        return data;
+    }
+
+    RowReader rows(query);
+    const int id = rows.column("product_id");
+    const int name = rows.column("product_name");
+    const int price = rows.column("price");
+    const int category = rows.column("category");
+    const int quantity = rows.column("quantity");
+    const int sku = rows.column("sku");
+    QVector<quint64> grams;
+    while (rows.next()) {
+        IndexedProduct product;
+        product.id = rows.toInt(id);
+        product.name = rows.toString(name);
+        product.price = rows.toDouble(price);
+        product.category = rows.toString(category);
+        product.quantity = rows.toInt(quantity);
+        product.sku = rows.toString(sku).trimmed();
+
+        const int slot = data.products.size();
+        const QString foldedName = fold(product.name);
+        const QString foldedCategory = fold(product.category);
+
+        grams.clear();
+        addTrigrams(grams, foldedName);
+        addTrigrams(grams, foldedCategory);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        for (const quint64 gram : grams) data.postings[gram].append(slot);
+
+        data.slotById.insert(product.id, slot);
+        if (!product.sku.isEmpty()) data.slotBySku.insert(product.sku, slot);
+        data.foldedNames.append(foldedName);
+        data.foldedCategories.append(foldedCategory);
+        data.products.append(product);
+    }
+
+    data.built = true;
+    return data;
+}
+
+bool ProductIndex::build()
+{
+    Data data = load(m_pool);
+    if (!data.built) return false;
+
+    m_data = std::move(data);
+    ++m_generation;
+    return true;
+}
+
+void ProductIndex::clear()
+{
+    m_data = Data();
+    m_rebuildQueued = false;
+    ++m_generation;
+}
+
+void ProductIndex::rebuild()
+{
+    if (!m_data.built) return; // Not logged in; login builds it
+    if (m_rebuildWatcher.isRunning()) {
+        m_rebuildQueued = true; // The running load may predate this change
+        return;
+    }
+
+    m_rebuildGeneration = m_generation;
+    ConnectionPool *pool = m_pool;
+    m_rebuildWatcher.setFuture(QtConcurrent::run([pool]() { return load(pool); }));
+}
+
+void ProductIndex::onRebuildFinished()
+{
+    Data fresh = m_rebuildWatcher.result();
+    if (!m_data.built) return; // Cleared by logout while loading
+
+    // Another change or a quantity delta landed while the load ran; its snapshot may miss it
+    if (m_rebuildQueued || m_rebuildGeneration != m_generation) {
+        m_rebuildQueued = false;
+        rebuild();
+        return;
+    }
+    if (!fresh.built) return;
+
+    m_data = std::move(fresh);
+}
+
+void ProductIndex::adjustQuantity(int productId, int delta)
+{
+    const auto it = m_data.slotById.constFind(productId);
+    if (it == m_data.slotById.constEnd()) return;
+    m_data.products[it.value()].quantity += delta;
+    ++m_generation;
+}
+
+const IndexedProduct *ProductIndex::product(int productId) const
+{
+    const auto it = m_data.slotById.constFind(productId);
+    return it == m_data.slotById.constEnd() ? nullptr : &m_data.products.at(it.value());
+}
+
+const IndexedProduct *ProductIndex::productByCode(const QString &code) const
+{
+    const auto it = m_data.slotBySku.constFind(code.trimmed());
+    return it == m_data.slotBySku.constEnd() ? nullptr : &m_data.products.at(it.value());
+}
+
+QVector<int> ProductIndex::search(const QString &text, int limit, bool inStockOnly, bool fuzzy) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<int> ids;
+    const QString query = fold(text);
+    if (!m_data.built || query.isEmpty()) return ids;
+
+    struct Candidate { int slot; int tier; int hits; };
+    QVector<Candidate> candidates;
+    // One or two characters have no trigrams to agree on, so near misses would be every product
+    const bool nearMisses = fuzzy && query.size() >= 3;
+    auto consider = [&](int slot, int hits) {
+        if (inStockOnly && m_data.products.at(slot).quantity <= 0) return;
+        const int tier = matchTier(m_data.foldedNames.at(slot), m_data.foldedCategories.at(slot), query);
+        if (tier == NearMiss && !nearMisses) return;
+        candidates.append({slot, tier, hits});
+    };
+
+    if (query.size() < 3) {
+        // Too short for a trigram; the folded names are in memory, so scan them
+        for (int slot = 0; slot < m_data.products.size(); ++slot) consider(slot, 0);
+    } else {
+        QVector<quint64> grams;
+        for (int i = 0; i + 3 <= query.size(); ++i) grams.append(trigramKey(query.constData() + i));
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+        QHash<int, int> hits;
+        for (const quint64 gram : grams) {
+            const auto posting = m_data.postings.constFind(gram);
+            if (posting == m_data.postings.constEnd()) continue;
+            for (const int slot : posting.value()) ++hits[slot];
+        }
+
+        // A substring match has every trigram; a near miss needs two thirds of them
+        const int needed = fuzzy ? qMax(1, (grams.size() * 2 + 2) / 3) : grams.size();
+        for (auto it = hits.constBegin(); it != hits.constEnd(); ++it) {
+            if (it.value() >= needed) consider(it.key(), it.value());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](const Candidate &a, const Candidate &b) {
+        if (a.tier != b.tier) return a.tier < b.tier;
+        if (a.hits != b.hits) return a.hits > b.hits;
+        const QString &nameA = m_data.foldedNames.at(a.slot);
+        const QString &nameB = m_data.foldedNames.at(b.slot);
+        if (nameA.size() != nameB.size()) return nameA.size() < nameB.size();
+        return nameA < nameB;
+    });
+
+    const int count = limit < 0 ? candidates.size() : qMin(limit, int(candidates.size()));
+    ids.reserve(count);
+    for (int i = 0; i < count; ++i) ids.append(m_data.products.at(candidates.at(i).slot).id);
+
+    ++m_lookups;
+    m_lookupNsecs += timer.nsecsElapsed();
+    return ids;
+}
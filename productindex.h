@@ -0,0 +1,86 @@
+#ifndef PRODUCTINDEX_H
+#define PRODUCTINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QFutureWatcher>
+
+class ConnectionPool;
+
+struct IndexedProduct {
+    int id = 0;
+    QString name;
+    QString category;
+    QString sku; // Barcode / SKU, empty if the product has none
+    double price = 0.0;
+    int quantity = 0;
+};
+
+// In-memory trigram index over product names and categories, so search-as-you-type never has
+// to run LIKE '%text%' scans against Products. Text is case- and diacritic-folded before it is
+// split into trigrams; a lookup intersects the posting lists and ranks prefix and substring
+// matches ahead of near misses. Built once at login, rebuilt in the background when products
+// change, and moved by quantity deltas from processSale. It also maps SKU / barcode to product
+// so a scan resolves without a round trip. Lives on the GUI thread.
+class ProductIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProductIndex(ConnectionPool *pool, QObject *parent = nullptr);
+    ~ProductIndex();
+
+    bool build(); // Synchronous; used at login
+    void clear();
+    bool isBuilt() const { return m_data.built; }
+    int size() const { return m_data.products.size(); }
+
+    // Ranked product ids matching text; limit < 0 returns every match. Near misses (most but
+    // not all trigrams present) are only returned when fuzzy is set and text has three or more characters.
+    QVector<int> search(const QString &text, int limit = -1, bool inStockOnly = false, bool fuzzy = false) const;
+    const IndexedProduct *product(int productId) const;
+    const IndexedProduct *productByCode(const QString &code) const; // Exact SKU / barcode match
+
+    // Quantity delta for a product, e.g. -sold after a sale commits
+    void adjustQuantity(int productId, int delta);
+
+    // Lowercased, accents stripped and whitespace simplified
+    static QString fold(const QString &text);
+
+    quint64 lookups() const { return m_lookups; }
+    qint64 lookupNsecs() const { return m_lookupNsecs; }
+
+public slots:
+    void rebuild(); // Background reload of Products; swaps in when done
+
+private slots:
+    void onRebuildFinished();
+
+private:
+    struct Data {
+        bool built = false;
+        QVector<IndexedProduct> products;
+        QVector<QString> foldedNames;
+        QVector<QString> foldedCategories;
+        QHash<int, int> slotById;
+        QHash<QString, int> slotBySku;
+        QHash<quint64, QVector<int>> postings; // Trigram -> ascending product slots
+    };
+
+    static Data load(ConnectionPool *pool);
+    static void addTrigrams(QVector<quint64> &out, const QString &folded);
+    static quint64 trigramKey(const QChar *chars);
+
+    ConnectionPool *m_pool;
+    Data m_data;
+    quint64 m_generation;        // Bumped by every quantity delta
+    quint64 m_rebuildGeneration; // Generation the running rebuild started from
+    bool m_rebuildQueued;
+    QFutureWatcher<Data> m_rebuildWatcher;
+    mutable quint64 m_lookups;
+    mutable qint64 m_lookupNsecs;
+};
+
+#endif // PRODUCTINDEX_H
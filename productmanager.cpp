@@ -4,44 +4,147 @@
 #include <QDebug>
 
 ProductManager::ProductManager(DatabaseHandler *dbHandler, QObject *parent)
-    : QObject(parent), m_dbHandler(dbHandler) {}
+    : QObject(parent), m_dbHandler(dbHandler), m_loader(new ModelLoader(dbHandler, "products", this))
+    , m_importer(new ProductImporter(dbHandler->pool(), dbHandler->dialect(), this))
+{
+    connect(m_importer, &ProductImporter::progress, this, &ProductManager::importProgress);
+    connect(m_importer, &ProductImporter::finished, this, &ProductManager::onImportFinished);
+}
 
-bool ProductManager::loadProducts(QTableWidget *tableWidget)
+RowBufferModel *ProductManager::createModel(const QStringList &headers, QObject *parent)
 {
-    return populateTable(tableWidget,
-                         "SELECT product_id, product_name, price, category, quantity, updated_at "
-                         "FROM Products ORDER BY product_name");
+    return new TableModel<ProductsTable>(headers, parent);
 }
 
-void ProductManager::searchProducts(QTableWidget *tableWidget, const QString &searchText)
+bool ProductManager::loadProducts(RowBufferModel *model)
 {
-    QSqlQuery query;
-    query.prepare("SELECT product_id, product_name, price, category, quantity, updated_at "
-                  "FROM Products WHERE CONCAT(product_name, category) LIKE ? ORDER BY product_name");
-    query.addBindValue("%" + searchText + "%");
+    return m_loader->submit(model, TableSql<ProductsTable>::select() + " ORDER BY product_name",
+                            {}, DatabaseWorker::Background) != 0;
+}
+
+quint64 ProductManager::searchProducts(RowBufferModel *model, const QString &searchText)
+{
+    const QString select = TableSql<ProductsTable>::select() + " ";
+    ProductIndex *index = m_dbHandler->productIndex();
+    if (!index->isBuilt()) {
+        return m_loader->submit(model, select + "WHERE " + m_dbHandler->dialect()->concat({"product_name", "category"})
+                                           + " LIKE ? ORDER BY product_name",
+                                {"%" + searchText + "%"}, DatabaseWorker::Interactive);
+    }
+
+    // The index finds the matches; the server only fetches those rows by primary key, in the
+    // index's ranking order. The id list is padded to a power of two so only a handful of
+    // distinct statements get prepared.
+    const QVector<int> ids = index->search(searchText);
+    if (ids.isEmpty()) {
+        return m_loader->submit(model, select + "WHERE FALSE", {}, DatabaseWorker::Interactive);
+    }
+    int paddedCount = 8;
+    while (paddedCount < ids.size()) paddedCount *= 2;
 
-    populateTableWithQuery(tableWidget, query);
+    QVariantList params;
+    QStringList placeholders;
+    QStringList ranks;
+    for (int i = 0; i < paddedCount; ++i) {
+        params.append(ids.at(qMin(i, int(ids.size()) - 1)));
+        placeholders.append("?");
+        ranks.append(QString("WHEN ? THEN %1").arg(i));
+    }
+    for (int i = 0; i < paddedCount; ++i) params.append(params.at(i)); // The same ids again for the ranks
+    return m_loader->submit(model, select + "WHERE product_id IN (" + placeholders.join(", ") + ") "
+                                   "ORDER BY CASE product_id " + ranks.join(" ") + " END",
+                            params, DatabaseWorker::Interactive);
 }
 
 bool ProductManager::addProduct(const QString &name, double price, const QString &category,
-                                int quantity, const QDate &dateAdded)
+                                int quantity, const QDate &dateAdded, const QString &sku)
 {
-    return executeQuery(
-        "INSERT INTO Products (product_name, price, category, quantity, updated_at) VALUES (?, ?, ?, ?, ?)",
-        {name, price, category, quantity, dateAdded});
+    if (!m_dbHandler->isConnected()) return false;
+
+    // The ProductStock summary row is written in the same transaction as the product
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    QSqlQuery query;
+    query.prepare("INSERT INTO Products (product_name, price, category, quantity, updated_at, sku) VALUES (?, ?, ?, ?, ?, ?)");
+    query.addBindValue(name);
+    query.addBindValue(price);
+    query.addBindValue(category);
+    query.addBindValue(quantity);
+    query.addBindValue(dateAdded);
+    query.addBindValue(sku.trimmed().isEmpty() ? QVariant() : QVariant(sku.trimmed())); // NULL keeps the unique key free
+    if (!query.exec()) {
+        qDebug() << "Query failed:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    const QVariant productId = query.lastInsertId();
+
+    query.prepare("INSERT INTO ProductStock (product_id, product_name, price, category, quantity, sold_quantity) "
+                  "VALUES (?, ?, ?, ?, ?, 0)");
+    query.addBindValue(productId);
+    query.addBindValue(name);
+    query.addBindValue(price);
+    query.addBindValue(category);
+    query.addBindValue(quantity);
+    if (!query.exec()) {
+        qDebug() << "Failed to add stock summary row:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    db.commit();
+    m_dbHandler->counters()->addProducts(1, quantity);
+    emit productsUpdated();
+    return true;
 }
 
 bool ProductManager::removeProduct(int productId)
 {
-    return executeQuery("DELETE FROM Products WHERE product_id = ?", {productId});
+    if (!m_dbHandler->isConnected()) return false;
+
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    // Remaining quantity leaves the stock total along with the product
+    QSqlQuery query;
+    query.prepare("SELECT quantity FROM Products WHERE product_id = ?" + m_dbHandler->dialect()->forUpdate());
+    query.addBindValue(productId);
+    if (!query.exec()) {
+        qDebug() << "Query failed:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    const bool found = query.next();
+    const int quantity = found ? query.value(0).toInt() : 0;
+
+    for (const char *sql : {"DELETE FROM ProductStock WHERE product_id = ?",
+                            "DELETE FROM Products WHERE product_id = ?"}) {
+        query.prepare(sql);
+        query.addBindValue(productId);
+        if (!query.exec()) {
+            qDebug() << "Query failed:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    db.commit();
+    if (found) m_dbHandler->counters()->addProducts(-1, -quantity);
+    emit productsUpdated();
+    return true;
 }
 
 bool ProductManager::getProductStats(int &totalProducts, int &totalStock)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query("SELECT COUNT(*) as count, COALESCE(SUM(quantity), 0) as stock FROM Products");
-    if (query.exec() && query.next()) {
+    // Uses a pooled connection so it can run alongside the other dashboard stats
+    PooledConnection connection(m_dbHandler->pool());
+    if (!connection.isValid()) return false;
+
+    QSqlQuery query(connection.database());
+    if (query.exec("SELECT COUNT(*) as count, COALESCE(SUM(quantity), 0) as stock FROM Products") && query.next()) {
         totalProducts = query.value(0).toInt();
         totalStock = query.value(1).toInt();
         return true;
@@ -49,47 +152,26 @@ bool ProductManager::getProductStats(int &totalProducts, int &totalStock)
     return false;
 }
 
-// Private helper methods
-bool ProductManager::populateTable(QTableWidget *tableWidget, const QString &sql)
-{
-    QSqlQuery query(sql);
-    return populateTableWithQuery(tableWidget, query);
-}
-
-bool ProductManager::populateTableWithQuery(QTableWidget *tableWidget, QSqlQuery &query)
+bool ProductManager::importProducts(const QString &path)
 {
-    if (!m_dbHandler->isConnected() || !query.exec()) {
-        qDebug() << "Query failed:" << query.lastError().text();
+    if (!m_dbHandler->isConnected()) {
+        qDebug() << "Cannot import products: database not connected";
         return false;
     }
-
-    tableWidget->setRowCount(0);
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
-        for (int col = 0; col < 5; col++) {
-            tableWidget->setItem(row, col, new QTableWidgetItem(query.value(col).toString()));
-        }
-        // Format datetime for last column
-        tableWidget->setItem(row, 5, new QTableWidgetItem(
-                                         query.value(5).toDateTime().toString("yyyy-MM-dd")));
-        row++;
-    }
-    return true;
+    return m_importer->start(path);
 }
 
-bool ProductManager::executeQuery(const QString &sql, const QVariantList &params)
+void ProductManager::cancelImport()
 {
-    if (!m_dbHandler->isConnected()) return false;
+    m_importer->cancel();
+}
 
-    QSqlQuery query;
-    query.prepare(sql);
-    for (const auto &param : params) {
-        query.addBindValue(param);
+// One refresh for the whole import rather than one per product
+void ProductManager::onImportFinished(const ImportReport &report)
+{
+    if (report.imported > 0) {
+        m_dbHandler->counters()->addProducts(report.imported, report.stockAdded);
+        emit productsUpdated();
     }
-
-    bool success = query.exec();
-    if (success) emit productsUpdated();
-    else qDebug() << "Query failed:" << query.lastError().text();
-    return success;
+    emit importFinished(report);
 }
@@ -2,10 +2,13 @@
 #define PRODUCTMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
 #include <QDate>
 #include <QSqlQuery>
 #include "databasehandler.h"
+#include "rowbuffermodel.h"
+#include "modelloader.h"
+#include "tables.h"
+#include "productimporter.h"
 
 class ProductManager : public QObject
 {
@@ -13,23 +16,32 @@ class ProductManager : public QObject
 public:
     explicit ProductManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
 
-    bool loadProducts(QTableWidget *tableWidget);
-    void searchProducts(QTableWidget *tableWidget, const QString &searchText);
+    // Model laid out as ProductsTable, like every product SELECT below
+    static RowBufferModel *createModel(const QStringList &headers, QObject *parent = nullptr);
+
+    bool loadProducts(RowBufferModel *model);
+    quint64 searchProducts(RowBufferModel *model, const QString &searchText); // Worker request id
     bool addProduct(const QString &name, double price, const QString &category,
-                    int quantity, const QDate &dateAdded);
+                    int quantity, const QDate &dateAdded, const QString &sku = QString());
     bool removeProduct(int productId);
     bool getProductStats(int &totalProducts, int &totalStock);
 
+    // Bulk import from CSV in the background; see ProductImporter for the file format
+    bool importProducts(const QString &path); // False if an import is already running
+    void cancelImport();
+
 signals:
     void productsUpdated();
+    void importProgress(qint64 bytesRead, qint64 totalBytes, int imported, int rejected);
+    void importFinished(const ImportReport &report);
+
+private slots:
+    void onImportFinished(const ImportReport &report);
 
 private:
     DatabaseHandler *m_dbHandler;
-
-    // Helper methods to reduce code duplication
-    bool populateTable(QTableWidget *tableWidget, const QString &sql);
-    bool populateTableWithQuery(QTableWidget *tableWidget, QSqlQuery &query);
-    bool executeQuery(const QString &sql, const QVariantList &params = {});
+    ModelLoader *m_loader;
+    ProductImporter *m_importer;
 };
 
 #endif // PRODUCTMANAGER_H
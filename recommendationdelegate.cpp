@@ -0,0 +1,64 @@
+#include "recommendationdelegate.h"
+#include "recommendationmodel.h"
+#include <QPainter>
+#include <QColor>
+
+namespace {
+const int kRowHeight = 56;
+const int kMargin = 2;    // Between cards
+const int kPadding = 10;  // Inside a card
+const QColor kCardColor(0x1e, 0x1e, 0x1e);
+const QColor kHoverColor(0x2a, 0x2a, 0x2a);
+const QColor kSelectedColor(0x43, 0x6c, 0xfd);
+const QColor kTitleColor(Qt::white);
+const QColor kDetailColor(0xaa, 0xaa, 0xaa);
+}
+
+RecommendationDelegate::RecommendationDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+    m_titleFont.setPixelSize(14);
+    m_titleFont.setBold(true);
+    m_detailFont.setPixelSize(12);
+}
+
+void RecommendationDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const QRect card = option.rect.adjusted(kMargin, kMargin, -kMargin, -kMargin);
+    const QColor background = option.state & QStyle::State_Selected ? kSelectedColor
+                              : option.state & QStyle::State_MouseOver ? kHoverColor
+                                                                       : kCardColor;
+    const double price = index.data(RecommendationModel::PriceRole).toDouble();
+    const int quantity = index.data(RecommendationModel::QuantityRole).toInt();
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(background);
+    painter->drawRoundedRect(card, 5, 5);
+
+    const QRect content = card.adjusted(kPadding, 5, -kPadding, -5);
+    const QString priceText = QString("%1 Rs.").arg(price, 0, 'f', 2);
+    painter->setFont(m_titleFont);
+    const int priceWidth = painter->fontMetrics().horizontalAdvance(priceText);
+    painter->setPen(kTitleColor);
+    painter->drawText(content, Qt::AlignRight | Qt::AlignVCenter, priceText);
+
+    const QRect text = content.adjusted(0, 0, -(priceWidth + kPadding), 0);
+    const QRect titleRect(text.left(), text.top(), text.width(), text.height() / 2);
+    const QRect detailRect(text.left(), titleRect.bottom(), text.width(), text.height() - titleRect.height());
+    const QString name = painter->fontMetrics().elidedText(index.data().toString(), Qt::ElideRight, text.width());
+    painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, name);
+
+    painter->setFont(m_detailFont);
+    painter->setPen(kDetailColor);
+    painter->drawText(detailRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      QString("Stock: %1 | %2 Rs./Unit").arg(quantity).arg(price, 0, 'f', 2));
+    painter->restore();
+}
+
+QSize RecommendationDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), kRowHeight);
+}
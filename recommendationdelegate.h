@@ -0,0 +1,24 @@
+#ifndef RECOMMENDATIONDELEGATE_H
+#define RECOMMENDATIONDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QFont>
+
+// Paints one recommendation as a card: name and "Stock: n | p Rs./Unit" on the left, the price
+// on the right. Fonts and colours are set up once; painting a row allocates only its text.
+class RecommendationDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit RecommendationDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    QFont m_titleFont;
+    QFont m_detailFont;
+};
+
+#endif // RECOMMENDATIONDELEGATE_H
@@ -0,0 +1,55 @@
+#include "recommendationmodel.h"
+
+RecommendationModel::RecommendationModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int RecommendationModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_products.size();
+}
+
+QVariant RecommendationModel::data(const QModelIndex &index, int role) const
+{
+    const IndexedProduct *item = product(index.row());
+    if (!index.isValid() || !item) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole: return item->name;
+    case Qt::ToolTipRole: return item->category;
+    case PriceRole: return item->price;
+    case QuantityRole: return item->quantity;
+    default: return QVariant();
+    }
+}
+
+void RecommendationModel::setProducts(const QVector<IndexedProduct> &products)
+{
+    const int oldCount = m_products.size();
+    const int newCount = products.size();
+
+    if (newCount < oldCount) {
+        beginRemoveRows(QModelIndex(), newCount, oldCount - 1);
+        m_products.resize(newCount);
+        endRemoveRows();
+    }
+    const int kept = qMin(oldCount, newCount);
+    for (int row = 0; row < kept; ++row) m_products[row] = products.at(row);
+    if (kept > 0) emit dataChanged(index(0), index(kept - 1));
+    if (newCount > oldCount) {
+        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+        for (int row = oldCount; row < newCount; ++row) m_products.append(products.at(row));
+        endInsertRows();
+    }
+}
+
+void RecommendationModel::clear()
+{
+    setProducts({});
+}
+
+const IndexedProduct *RecommendationModel::product(int row) const
+{
+    return row >= 0 && row < m_products.size() ? &m_products.at(row) : nullptr;
+}
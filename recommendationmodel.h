@@ -0,0 +1,31 @@
+#ifndef RECOMMENDATIONMODEL_H
+#define RECOMMENDATIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "productindex.h"
+
+// The handful of products suggested for the search text. Results are swapped in place: rows
+// that stay are reported as changed and only the difference in count is inserted or removed,
+// so the view repaints instead of rebuilding on every keystroke.
+class RecommendationModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role { PriceRole = Qt::UserRole + 1, QuantityRole };
+
+    explicit RecommendationModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setProducts(const QVector<IndexedProduct> &products);
+    void clear();
+    const IndexedProduct *product(int row) const;
+
+private:
+    QVector<IndexedProduct> m_products;
+};
+
+#endif // RECOMMENDATIONMODEL_H
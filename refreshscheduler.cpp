@@ -0,0 +1,40 @@
+#include "refreshscheduler.h"
+
+RefreshScheduler::RefreshScheduler(QObject *parent)
+    : QObject(parent)
+    , m_requested(0)
+    , m_runs(0)
+{
+    // A zero-interval single shot fires once control returns to the event loop
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &RefreshScheduler::flush);
+}
+
+void RefreshScheduler::setHandler(DataSet dataSet, std::function<void()> handler)
+{
+    m_handlers.insert(dataSet, std::move(handler));
+}
+
+void RefreshScheduler::markDirty(DataSets dataSets)
+{
+    for (int bit = 1; bit <= LastDataSet; bit <<= 1) {
+        if (dataSets.testFlag(static_cast<DataSet>(bit))) ++m_requested;
+    }
+    m_dirty |= dataSets;
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void RefreshScheduler::flush()
+{
+    // Take the flags first so a handler marking more work schedules another turn
+    const DataSets dirty = m_dirty;
+    m_dirty = DataSets();
+
+    for (int bit = 1; bit <= LastDataSet; bit <<= 1) {
+        if (!dirty.testFlag(static_cast<DataSet>(bit))) continue;
+        ++m_runs;
+        const auto handler = m_handlers.value(bit);
+        if (handler) handler();
+    }
+}
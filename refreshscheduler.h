@@ -0,0 +1,55 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <functional>
+
+// Collects dirty flags per data set and runs each registered reload at most once per event-loop
+// turn. Signals that fan out to overlapping reloads (a sale touching sales, stock and products)
+// just mark the sets they affect; repeated marks before the flush are coalesced into one run.
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum DataSet {
+        Debtors = 0x01,
+        Products = 0x02,
+        Vendors = 0x04,
+        Workers = 0x08,
+        Stock = 0x10,
+        ProductSales = 0x20, // Product picker on the sales page
+        NewSales = 0x40,     // Delta fetch into the sales history
+        SalesChart = 0x80,
+        DashboardSales = 0x100, // SalesDashboard's product list and history after a sale
+        LastDataSet = DashboardSales
+    };
+    Q_DECLARE_FLAGS(DataSets, DataSet)
+
+    explicit RefreshScheduler(QObject *parent = nullptr);
+
+    // Reloads run in ascending DataSet order within a flush
+    void setHandler(DataSet dataSet, std::function<void()> handler);
+    void markDirty(DataSets dataSets);
+
+    // Counters for how much work the coalescing saved
+    quint64 requestedCount() const { return m_requested; }
+    quint64 runCount() const { return m_runs; }
+    quint64 coalescedCount() const { return m_requested - m_runs; }
+
+private slots:
+    void flush();
+
+private:
+    QHash<int, std::function<void()>> m_handlers;
+    DataSets m_dirty;
+    QTimer m_flushTimer;
+    quint64 m_requested;
+    quint64 m_runs;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RefreshScheduler::DataSets)
+
+#endif // REFRESHSCHEDULER_H
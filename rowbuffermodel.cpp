@@ -0,0 +1,231 @@
+#include "rowbuffermodel.h"
+#include "databaseworker.h"
+#include <QSqlQuery>
+#include <QDate>
+#include <QDateTime>
+
+RowBufferModel::RowBufferModel(const QVector<Column> &columns, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_columns(columns)
+    , m_rowCount(0)
+    , m_buffers(columns.size())
+    , m_frontBuffers(columns.size())
+    , m_frontCount(0)
+{
+    clearBuffers();
+}
+
+QVector<RowBufferModel::Column> RowBufferModel::describe(const QStringList &headers,
+                                                         const QVector<ColumnType> &types)
+{
+    QVector<Column> columns;
+    columns.reserve(types.size());
+    for (int col = 0; col < types.size(); ++col) {
+        columns.append({headers.value(col), types[col]});
+    }
+    return columns;
+}
+
+int RowBufferModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int RowBufferModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_columns.size();
+}
+
+QVariant RowBufferModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount || index.column() >= m_columns.size()) return QVariant();
+
+    const int row = index.row();
+    const int column = index.column();
+    if (role == Qt::DisplayRole) {
+        return displayText(row, column);
+    }
+    if (role == Qt::UserRole) {
+        switch (m_columns[column].type) {
+        case Integer: return intValue(row, column);
+        case Real: return realValue(row, column);
+        case Text: return text(row, column);
+        case Date: return QDate::fromJulianDay(intValue(row, column));
+        case DateTime: return QDateTime::fromMSecsSinceEpoch(intValue(row, column));
+        }
+    }
+    return QVariant();
+}
+
+QVariant RowBufferModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role == Qt::DisplayRole && orientation == Qt::Horizontal && section >= 0 && section < m_columns.size()) {
+        return m_columns[section].header;
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void RowBufferModel::setRows(const DbResult &result)
+{
+    beginResetModel();
+    clearBuffers();
+    reserveRows(result.rows.size());
+    for (const auto &values : result.rows) {
+        appendRow(values);
+    }
+    endResetModel();
+}
+
+bool RowBufferModel::setRows(QSqlQuery &query)
+{
+    if (!query.isActive()) return false;
+
+    beginResetModel();
+    clearBuffers();
+    if (query.size() > 0) reserveRows(query.size());
+    while (query.next()) {
+        for (int col = 0; col < m_columns.size(); ++col) {
+            appendValue(col, query.value(col));
+        }
+        ++m_rowCount;
+    }
+    endResetModel();
+    return true;
+}
+
+void RowBufferModel::appendRows(const DbResult &result)
+{
+    if (result.rows.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), m_rowCount, m_rowCount + result.rows.size() - 1);
+    for (const auto &values : result.rows) {
+        appendRow(values);
+    }
+    endInsertRows();
+}
+
+void RowBufferModel::prependRows(const DbResult &result)
+{
+    if (result.rows.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), 0, result.rows.size() - 1);
+    for (int i = result.rows.size() - 1; i >= 0; --i) {
+        const QVariantList &values = result.rows[i];
+        for (int col = 0; col < m_columns.size(); ++col) {
+            appendTo(m_frontBuffers[col], m_columns[col].type, values.value(col));
+        }
+    }
+    m_frontCount += result.rows.size();
+    m_rowCount += result.rows.size();
+    endInsertRows();
+}
+
+void RowBufferModel::clear()
+{
+    beginResetModel();
+    clearBuffers();
+    endResetModel();
+}
+
+qint64 RowBufferModel::intValue(int row, int column) const
+{
+    const ColumnBuffer &buffer = locate(column, row);
+    return buffer.ints.value(row);
+}
+
+double RowBufferModel::realValue(int row, int column) const
+{
+    const ColumnBuffer &buffer = locate(column, row);
+    return buffer.reals.value(row);
+}
+
+QString RowBufferModel::text(int row, int column) const
+{
+    if (m_columns[column].type != Text) return displayText(row, column);
+    const ColumnBuffer &buffer = locate(column, row);
+    const int start = buffer.textOffsets[row];
+    return buffer.textPool.mid(start, buffer.textOffsets[row + 1] - start);
+}
+
+void RowBufferModel::appendRow(const QVariantList &values)
+{
+    for (int col = 0; col < m_columns.size(); ++col) {
+        appendValue(col, values.value(col));
+    }
+    ++m_rowCount;
+}
+
+void RowBufferModel::appendValue(int column, const QVariant &value)
+{
+    appendTo(m_buffers[column], m_columns[column].type, value);
+}
+
+void RowBufferModel::appendTo(ColumnBuffer &buffer, ColumnType type, const QVariant &value)
+{
+    switch (type) {
+    case Integer: appendTyped<Integer>(buffer, value); break;
+    case Real: appendTyped<Real>(buffer, value); break;
+    case Text: appendTyped<Text>(buffer, value); break;
+    case Date: appendTyped<Date>(buffer, value); break;
+    case DateTime: appendTyped<DateTime>(buffer, value); break;
+    }
+}
+
+void RowBufferModel::reserveRows(int rows)
+{
+    for (int col = 0; col < m_columns.size(); ++col) {
+        ColumnBuffer &buffer = m_buffers[col];
+        switch (m_columns[col].type) {
+        case Real: buffer.reals.reserve(rows); break;
+        case Text: buffer.textOffsets.reserve(rows + 1); break;
+        default: buffer.ints.reserve(rows); break;
+        }
+    }
+}
+
+void RowBufferModel::clearBuffers()
+{
+    for (auto *buffers : {&m_buffers, &m_frontBuffers}) {
+        for (auto &buffer : *buffers) {
+            buffer.ints.clear();
+            buffer.reals.clear();
+            buffer.textPool.clear();
+            buffer.textOffsets.clear();
+            buffer.textOffsets.append(0);
+        }
+    }
+    m_frontCount = 0;
+    m_rowCount = 0;
+}
+
+const RowBufferModel::ColumnBuffer &RowBufferModel::locate(int column, int &row) const
+{
+    if (row < m_frontCount) {
+        row = m_frontCount - 1 - row;
+        return m_frontBuffers[column];
+    }
+    row -= m_frontCount;
+    return m_buffers[column];
+}
+
+QString RowBufferModel::displayText(int row, int column) const
+{
+    if (m_columns[column].type == Text) return text(row, column);
+
+    const ColumnBuffer &buffer = locate(column, row);
+    switch (m_columns[column].type) {
+    case Integer:
+        return QString::number(buffer.ints[row]);
+    case Real:
+        return QString::number(buffer.reals[row], 'f', 2);
+    case Text:
+        break;
+    case Date:
+        return buffer.ints[row] == kNullTime ? QString()
+                                             : QDate::fromJulianDay(buffer.ints[row]).toString("yyyy-MM-dd");
+    case DateTime:
+        return buffer.ints[row] == kNullTime ? QString()
+                                             : QDateTime::fromMSecsSinceEpoch(buffer.ints[row]).toString("yyyy-MM-dd hh:mm:ss");
+    }
+    return QString();
+}
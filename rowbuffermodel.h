@@ -0,0 +1,111 @@
+#ifndef ROWBUFFERMODEL_H
+#define ROWBUFFERMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QStringList>
+#include <QVariant>
+#include <limits>
+#include "rowreader.h"
+
+class QSqlQuery;
+struct DbResult;
+
+// Read-only table model backed by one contiguous buffer per column. Rows are decoded once into
+// plain ints/doubles/packed text and only turned into display strings when a view asks for them,
+// so loading a large result set costs a few vector appends instead of a heap item per cell.
+class RowBufferModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum ColumnType { Integer, Real, Text, Date, DateTime };
+
+    struct Column {
+        QString header;
+        ColumnType type;
+    };
+
+    explicit RowBufferModel(const QVector<Column> &columns, QObject *parent = nullptr);
+    ~RowBufferModel() override = default;
+
+    // Pairs view headers with the column types a manager's SELECT produces
+    static QVector<Column> describe(const QStringList &headers, const QVector<ColumnType> &types);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Replace the contents; the source column order must match the model's columns
+    void setRows(const DbResult &result);
+    bool setRows(QSqlQuery &query);
+    void clear();
+
+    // Add rows after the current last row / before row 0 without resetting the view. Both cost
+    // O(new rows): prepended rows go to a separate front buffer stored in reverse order.
+    void appendRows(const DbResult &result);
+    void prependRows(const DbResult &result);
+
+    // Typed accessors for callers that need the raw value (ids, prices) rather than display text
+    qint64 intValue(int row, int column) const;
+    double realValue(int row, int column) const;
+    QString text(int row, int column) const;
+
+protected:
+    // Marks a NULL/invalid date or timestamp in the int buffer
+    static constexpr qint64 kNullTime = std::numeric_limits<qint64>::min();
+
+    // Every row from the worker comes through here. The default dispatches on each column's
+    // type; TableModel overrides it with one unrolled appendCell<Type> per column.
+    virtual void appendRow(const QVariantList &values);
+    void appendValue(int column, const QVariant &value);
+    template <ColumnType Type>
+    void appendCell(int column, const QVariant &value) { appendTyped<Type>(m_buffers[column], value); }
+    void reserveRows(int rows);
+    void clearBuffers();
+    QString displayText(int row, int column) const;
+
+    QVector<Column> m_columns;
+    int m_rowCount;
+
+private:
+    // Integer, Date (julian day) and DateTime (msecs since epoch) share the int buffer
+    struct ColumnBuffer {
+        QVector<qint64> ints;
+        QVector<double> reals;
+        QString textPool;
+        QVector<int> textOffsets; // rowCount + 1 entries into textPool
+    };
+
+    // Maps a model row to the buffer holding it and rewrites row to the index inside that buffer
+    const ColumnBuffer &locate(int column, int &row) const;
+    void appendTo(ColumnBuffer &buffer, ColumnType type, const QVariant &value);
+    template <ColumnType Type>
+    static void appendTyped(ColumnBuffer &buffer, const QVariant &value);
+
+    QVector<ColumnBuffer> m_buffers;
+    QVector<ColumnBuffer> m_frontBuffers; // Prepended rows, last element is model row 0
+    int m_frontCount;
+};
+
+template <RowBufferModel::ColumnType Type>
+void RowBufferModel::appendTyped(ColumnBuffer &buffer, const QVariant &value)
+{
+    if constexpr (Type == Integer) {
+        buffer.ints.append(value.toLongLong());
+    } else if constexpr (Type == Real) {
+        buffer.reals.append(value.toDouble());
+    } else if constexpr (Type == Text) {
+        buffer.textPool += value.toString();
+        buffer.textOffsets.append(buffer.textPool.size());
+    } else if constexpr (Type == Date) {
+        const QDate date = RowReader::decodeDate(value);
+        buffer.ints.append(date.isValid() ? date.toJulianDay() : kNullTime);
+    } else {
+        const QDateTime dateTime = RowReader::decodeDateTime(value);
+        buffer.ints.append(dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : kNullTime);
+    }
+}
+
+#endif // ROWBUFFERMODEL_H
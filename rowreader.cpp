@@ -0,0 +1,66 @@
+#include "rowreader.h"
+#include <QSqlRecord>
+#include <QDebug>
+
+namespace {
+// Digits at text[from, from + count), or -1 if any isn't one
+int digits(const QChar *text, int from, int count)
+{
+    int value = 0;
+    for (int i = from; i < from + count; ++i) {
+        const ushort c = text[i].unicode();
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// "yyyy-MM-dd" at the start of text, as stored by SQLite and returned for MySQL DATETIME text
+QDate parseDate(const QString &text)
+{
+    if (text.size() < 10 || text.at(4) != QLatin1Char('-') || text.at(7) != QLatin1Char('-')) return QDate();
+    const QChar *data = text.constData();
+    return QDate(digits(data, 0, 4), digits(data, 5, 2), digits(data, 8, 2));
+}
+}
+
+RowReader::RowReader(QSqlQuery &query)
+    : m_query(query)
+    , m_rows(0)
+{
+    if (!query.isForwardOnly()) qDebug() << "RowReader over a scrollable query; results are cached client side";
+}
+
+bool RowReader::next()
+{
+    if (!m_query.next()) return false;
+    ++m_rows;
+    return true;
+}
+
+int RowReader::column(const QString &name) const
+{
+    const int index = m_query.record().indexOf(name);
+    if (index < 0) qDebug() << "Result has no column" << name << "in:" << m_query.lastQuery();
+    return index;
+}
+
+QDate RowReader::decodeDate(const QVariant &value)
+{
+    if (value.type() == QVariant::String) return parseDate(value.toString());
+    return value.toDate();
+}
+
+QDateTime RowReader::decodeDateTime(const QVariant &value)
+{
+    if (value.type() != QVariant::String) return value.toDateTime();
+
+    // "yyyy-MM-dd HH:mm:ss", with a 'T' if Qt wrote it; fractions and zones take the slow path
+    const QString text = value.toString();
+    const QDate date = parseDate(text);
+    if (text.size() != 19 || !date.isValid() || text.at(13) != QLatin1Char(':') || text.at(16) != QLatin1Char(':')) {
+        return QDateTime::fromString(text, Qt::ISODate);
+    }
+    const QChar *data = text.constData();
+    return QDateTime(date, QTime(digits(data, 11, 2), digits(data, 14, 2), digits(data, 17, 2)));
+}
@@ -0,0 +1,45 @@
+#ifndef ROWREADER_H
+#define ROWREADER_H
+
+#include <QSqlQuery>
+#include <QString>
+#include <QDate>
+#include <QDateTime>
+
+// Typed, forward-only access to the rows of an executed query. Columns may be named: names are
+// resolved against the result's record once, when the reader is made, so a loop pays an array
+// index per cell rather than a field search. Each cell is fetched once and converted straight
+// to the requested type; dates that come back as text (SQLite) are parsed in place instead of
+// going through QVariant's string conversions.
+//
+// The query should be set forward-only before it is executed; the reader can't change that
+// afterwards and warns if it finds a scrollable one.
+class RowReader
+{
+public:
+    explicit RowReader(QSqlQuery &query);
+
+    bool next();
+    int column(const QString &name) const; // -1, and a log line, if the result has no such column
+
+    bool isNull(int column) const { return m_query.isNull(column); }
+    int toInt(int column) const { return m_query.value(column).toInt(); }
+    qint64 toInt64(int column) const { return m_query.value(column).toLongLong(); }
+    double toDouble(int column) const { return m_query.value(column).toDouble(); }
+    bool toBool(int column) const { return m_query.value(column).toBool(); }
+    QString toString(int column) const { return m_query.value(column).toString(); }
+    QDate toDate(int column) const { return decodeDate(m_query.value(column)); }
+    QDateTime toDateTime(int column) const { return decodeDateTime(m_query.value(column)); }
+
+    // The same conversions for cells already fetched, e.g. rows handed over by the worker
+    static QDate decodeDate(const QVariant &value);
+    static QDateTime decodeDateTime(const QVariant &value);
+
+    int rows() const { return m_rows; } // Rows read so far
+
+private:
+    QSqlQuery &m_query;
+    int m_rows;
+};
+
+#endif // ROWREADER_H
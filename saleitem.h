@@ -2,6 +2,7 @@
 #define SALEITEM_H
 
 #include <QString>
+#include <QDateTime>
 
 struct SaleItem {
     int productId;
@@ -13,4 +14,22 @@ struct SaleItem {
     double totalPrice;
 };
 
+// A product processSale could not decrement because another sale got to the stock first
+struct StockShortage {
+    int productId;
+    QString productName;
+    int requested;
+    int available;
+};
+
+// One checkout: the Orders header its Sales lines reference
+struct SaleOrder {
+    int orderId = 0;
+    int salesmanId = 0;
+    QDateTime orderDate;
+    double totalAmount = 0.0;
+    int itemCount = 0; // Lines
+    int unitCount = 0;
+};
+
 #endif // SALEITEM_H
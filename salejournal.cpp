@@ -0,0 +1,219 @@
+#include "salejournal.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QMutexLocker>
+#include <QDebug>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+const quint32 kRecordMagic = 0x534A5231; // "SJR1"
+const int kHeaderSize = 12;              // magic, length, crc
+
+quint32 crc32(const QByteArray &data)
+{
+    quint32 crc = 0xFFFFFFFFu;
+    for (const char byte : data) {
+        crc ^= static_cast<quint8>(byte);
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+QJsonObject saleToJson(const JournaledSale &sale)
+{
+    QJsonArray items;
+    for (const auto &item : sale.items) {
+        items.append(QJsonObject{
+            {"product_id", item.productId}, {"name", item.productName}, {"price", item.unitPrice},
+            {"category", item.category}, {"quantity", item.quantity}, {"total", item.totalPrice}});
+    }
+    return QJsonObject{{"type", "sale"}, {"id", sale.id}, {"user_id", sale.userId},
+                       {"created_at", sale.createdAt.toString(Qt::ISODateWithMs)}, {"items", items}};
+}
+
+JournaledSale saleFromJson(const QJsonObject &object)
+{
+    JournaledSale sale;
+    sale.id = object.value("id").toString();
+    sale.userId = object.value("user_id").toInt(-1);
+    sale.createdAt = QDateTime::fromString(object.value("created_at").toString(), Qt::ISODateWithMs);
+    for (const auto &value : object.value("items").toArray()) {
+        const QJsonObject line = value.toObject();
+        SaleItem item;
+        item.productId = line.value("product_id").toInt();
+        item.productName = line.value("name").toString();
+        item.unitPrice = line.value("price").toDouble();
+        item.category = line.value("category").toString();
+        item.available = 0;
+        item.quantity = line.value("quantity").toInt();
+        item.totalPrice = line.value("total").toDouble();
+        sale.items.append(item);
+    }
+    return sale;
+}
+}
+
+SaleJournal::SaleJournal(const QString &path)
+    : m_path(path)
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    load();
+}
+
+QString SaleJournal::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sale-journal.bin";
+}
+
+bool SaleJournal::load()
+{
+    QFile file(m_path);
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Failed to open sale journal:" << file.errorString();
+        return false;
+    }
+
+    QDataStream in(&file);
+    qint64 validEnd = 0;
+    while (!in.atEnd()) {
+        quint32 magic = 0, length = 0, checksum = 0;
+        in >> magic >> length >> checksum;
+        if (in.status() != QDataStream::Ok || magic != kRecordMagic || length > (1u << 24)) break;
+        QByteArray payload(static_cast<int>(length), Qt::Uninitialized);
+        if (in.readRawData(payload.data(), payload.size()) != payload.size() || crc32(payload) != checksum) break;
+        validEnd = file.pos();
+
+        const QJsonObject record = QJsonDocument::fromJson(payload).object();
+        const QString type = record.value("type").toString();
+        if (type == "sale") {
+            m_pending.append(saleFromJson(record));
+        } else {
+            // applied / rejected: the sale is settled
+            const QString id = record.value("id").toString();
+            for (int i = 0; i < m_pending.size(); ++i) {
+                if (m_pending.at(i).id == id) {
+                    m_pending.removeAt(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    const qint64 size = file.size();
+    file.close();
+    if (validEnd < size) {
+        // Torn or corrupt tail: that record never completed, so its sale was never confirmed
+        qDebug() << "Sale journal: dropping" << size - validEnd << "bytes of incomplete record at the tail";
+        QFile::resize(m_path, validEnd);
+    }
+    if (!m_pending.isEmpty()) qDebug() << "Sale journal:" << m_pending.size() << "sales awaiting replay";
+    return true;
+}
+
+bool SaleJournal::writeRecord(const QByteArray &payload)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Failed to open sale journal:" << file.errorString();
+        return false;
+    }
+
+    QByteArray frame;
+    frame.reserve(kHeaderSize + payload.size());
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out << kRecordMagic << static_cast<quint32>(payload.size()) << crc32(payload);
+    frame.append(payload);
+
+    if (file.write(frame) != frame.size() || !syncToDisk(file)) {
+        qDebug() << "Failed to write sale journal:" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SaleJournal::append(const JournaledSale &sale)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!writeRecord(QJsonDocument(saleToJson(sale)).toJson(QJsonDocument::Compact))) return false;
+    m_pending.append(sale);
+    return true;
+}
+
+QList<JournaledSale> SaleJournal::pending(int limit) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.mid(0, limit);
+}
+
+int SaleJournal::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.size();
+}
+
+bool SaleJournal::settle(const QString &id, const QByteArray &outcome)
+{
+    // Caller holds m_mutex
+    if (!writeRecord(outcome)) return false;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        if (m_pending.at(i).id == id) {
+            m_pending.removeAt(i);
+            break;
+        }
+    }
+
+    // Everything settled: start the next outage from an empty file
+    if (m_pending.isEmpty() && !QFile::resize(m_path, 0)) {
+        qDebug() << "Failed to truncate sale journal";
+    }
+    return true;
+}
+
+bool SaleJournal::markApplied(const QString &id)
+{
+    QMutexLocker locker(&m_mutex);
+    return settle(id, QJsonDocument(QJsonObject{{"type", "applied"}, {"id", id}}).toJson(QJsonDocument::Compact));
+}
+
+bool SaleJournal::markRejected(const QString &id, const QString &reason)
+{
+    QMutexLocker locker(&m_mutex);
+    for (const auto &sale : m_pending) {
+        if (sale.id != id) continue;
+
+        // Human-readable JSON lines; the rejects file is only ever appended to
+        QJsonObject record = saleToJson(sale);
+        record.insert("reason", reason);
+        QFile rejects(rejectsPath());
+        if (!rejects.open(QIODevice::WriteOnly | QIODevice::Append)
+            || rejects.write(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n') < 0
+            || !syncToDisk(rejects)) {
+            qDebug() << "Failed to write sale rejects:" << rejects.errorString();
+            return false;
+        }
+        break;
+    }
+    return settle(id, QJsonDocument(QJsonObject{{"type", "rejected"}, {"id", id}, {"reason", reason}})
+                          .toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,52 @@
+#ifndef SALEJOURNAL_H
+#define SALEJOURNAL_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include "saleitem.h"
+
+struct JournaledSale {
+    QString id; // Also the idempotency key when the sale is replayed
+    int userId = -1;
+    QDateTime createdAt;
+    QList<SaleItem> items;
+};
+
+// Append-only local journal for sales taken while the database is unreachable. Each record is
+// framed as magic, payload length and CRC-32, followed by a JSON payload, and is fsync'd before
+// append() returns, so a sale the cashier saw complete survives a crash or power cut. Outcome
+// records (applied / rejected) are appended as the replayer settles sales; once nothing is
+// pending the file is truncated. A torn record at the tail (crash mid-write) is dropped on load.
+// Thread-safe: the GUI appends while the replayer settles on a pool thread.
+class SaleJournal
+{
+public:
+    explicit SaleJournal(const QString &path);
+
+    bool append(const JournaledSale &sale);
+    QList<JournaledSale> pending(int limit) const; // Oldest first
+    int pendingCount() const;
+
+    bool markApplied(const QString &id);
+    // Settles the sale and copies it with the reason to the rejects file for manual follow-up
+    bool markRejected(const QString &id, const QString &reason);
+
+    QString path() const { return m_path; }
+    QString rejectsPath() const { return m_path + ".rejected"; }
+
+    static QString defaultPath();
+
+private:
+    bool load();
+    bool writeRecord(const QByteArray &payload);
+    bool settle(const QString &id, const QByteArray &outcome);
+
+    QString m_path;
+    QList<JournaledSale> m_pending;
+    mutable QMutex m_mutex;
+};
+
+#endif // SALEJOURNAL_H
@@ -2,7 +2,12 @@
 #include "databasehandler.h"
 #include "productmanager.h"
 #include "salesmanager.h"
-#include "clickableWidget.h"
+#include "recommendationmodel.h"
+#include "recommendationdelegate.h"
+#include "cartmodel.h"
+#include "cartdelegate.h"
+#include "rowbuffermodel.h"
+#include "searchcontroller.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -11,11 +16,12 @@
 #include <QDebug>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QElapsedTimer>
 
 SalesDashboard::SalesDashboard(DatabaseHandler *dbHandler, ProductManager *productManager,
                                SalesManager *salesManager, QWidget *parent)
     : QWidget(parent), m_dbHandler(dbHandler), m_productManager(productManager)
-    , m_salesManager(salesManager), m_totalAmount(0.0), m_currentSelectedRow(-1)
+    , m_salesManager(salesManager), m_searchController(nullptr), m_cart(nullptr), m_currentSelectedRow(-1)
 {
     setupUI();
     connectSignals();
@@ -34,14 +40,19 @@ void SalesDashboard::setupUI()
     setupProductSearch();
     leftLayout->addWidget(m_productSearchEdit);
 
-    // Recommendations
-    m_recommendLayout = new QVBoxLayout();
-    auto *recommendScroll = new QScrollArea(this);
-    auto *recommendWidget = new QWidget(this);
-    recommendWidget->setLayout(m_recommendLayout);
-    recommendScroll->setWidget(recommendWidget);
-    recommendScroll->setWidgetResizable(true);
-    leftLayout->addWidget(recommendScroll, 3);
+    // Recommendations: painted by the delegate, so a keystroke only swaps model rows
+    m_recommendModel = new RecommendationModel(this);
+    m_recommendView = new QListView(this);
+    m_recommendView->setModel(m_recommendModel);
+    m_recommendView->setItemDelegate(new RecommendationDelegate(m_recommendView));
+    m_recommendView->setUniformItemSizes(true);
+    m_recommendView->setMouseTracking(true); // Hover highlight
+    m_recommendView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_recommendView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_recommendView->setCursor(Qt::PointingHandCursor);
+    m_recommendView->setFrameShape(QFrame::NoFrame);
+    m_recommendView->setStyleSheet("QListView { background: transparent; }");
+    leftLayout->addWidget(m_recommendView, 3);
 
     // Debug tables (hidden)
     setupDebugTables();
@@ -68,9 +79,9 @@ void SalesDashboard::setupProductSearch()
 void SalesDashboard::setupDebugTables()
 {
     // Products table
-    m_productsTable = new QTableWidget(this);
-    m_productsTable->setColumnCount(6);
-    m_productsTable->setHorizontalHeaderLabels({"ID", "Name", "Price", "Category", "Stock", "Updated"});
+    m_productsModel = ProductManager::createModel({"ID", "Name", "Price", "Category", "Stock", "Updated"}, this);
+    m_productsTable = new QTableView(this);
+    m_productsTable->setModel(m_productsModel);
     m_productsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_productsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_productsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -81,12 +92,12 @@ void SalesDashboard::setupDebugTables()
     m_salesSearchEdit = new QLineEdit(this);
     m_salesSearchEdit->setPlaceholderText("Search Sales...");
 
-    m_salesTable = new QTableWidget(this);
-    m_salesTable->setColumnCount(8);
-    m_salesTable->setHorizontalHeaderLabels({
+    m_salesModel = m_salesManager->createSalesModel({
         "Sales ID", "Salesman ID", "Product ID", "Product Name",
         "Price", "Category", "Quantity Sold", "Date/Time"
-    });
+    }, this);
+    m_salesTable = new QTableView(this);
+    m_salesTable->setModel(m_salesModel);
     m_salesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_salesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_salesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -110,12 +121,17 @@ void SalesDashboard::setupRightPanel(QVBoxLayout *rightLayout)
     selectedScroll->setWidgetResizable(true);
     rightLayout->addWidget(selectedScroll, 3);
 
-    // Selected products table
-    m_selectedProductsTable = new QTableWidget(this);
-    m_selectedProductsTable->setColumnCount(5);
-    m_selectedProductsTable->setHorizontalHeaderLabels({"Product", "Price", "Qty", "Total", "Remove"});
+    // Selected products table; the delegate paints the remove buttons
+    m_cart = new CartModel(this);
+    auto *cartDelegate = new CartDelegate(this);
+    connect(cartDelegate, &CartDelegate::removeClicked, this, &SalesDashboard::removeProduct, Qt::QueuedConnection);
+    m_selectedProductsTable = new QTableView(this);
+    m_selectedProductsTable->setModel(m_cart);
+    m_selectedProductsTable->setItemDelegate(cartDelegate);
+    m_selectedProductsTable->setMouseTracking(true);
     m_selectedProductsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     m_selectedProductsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_selectedProductsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     m_selectedProductsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_selectedProductsTable->verticalHeader()->setVisible(false);
     rightLayout->addWidget(m_selectedProductsTable, 3);
@@ -169,29 +185,33 @@ void SalesDashboard::setupControls(QVBoxLayout *rightLayout)
 
 void SalesDashboard::connectSignals()
 {
-    // Search signals
-    connect(m_productSearchEdit, &QLineEdit::textChanged, this, &SalesDashboard::onProductSearchTextChanged);
-    connect(m_salesSearchEdit, &QLineEdit::textChanged, this, &SalesDashboard::onSalesSearchTextChanged);
+    // Search edits are debounced; a keystroke cancels the previous search still in flight
+    m_searchController = new SearchController(m_dbHandler, 250, this);
+    m_searchController->attach(m_productSearchEdit, [this](const QString &text) { return searchProducts(text); });
+    m_searchController->attach(m_salesSearchEdit, [this](const QString &text) { return searchSales(text); });
+
+    // A barcode scanner types the code into the search box and presses Enter
+    connect(m_productSearchEdit, &QLineEdit::returnPressed, this, &SalesDashboard::onCodeScanned);
 
     // Table selection signals
-    connect(m_productsTable, &QTableWidget::cellClicked, this, &SalesDashboard::onProductSelected);
-    connect(m_selectedProductsTable, &QTableWidget::cellClicked, this, &SalesDashboard::onSelectedProductClicked);
+    connect(m_productsTable, &QTableView::clicked, this, &SalesDashboard::onProductSelected);
+    connect(m_recommendView, &QListView::clicked, this, &SalesDashboard::onRecommendationClicked);
+    connect(m_selectedProductsTable, &QTableView::clicked, this, &SalesDashboard::onSelectedProductClicked);
+    connect(m_cart, &CartModel::totalChanged, this, [this](double total) {
+        m_totalLabel->setText(QString("%1 Rs.").arg(total, 0, 'f', 2));
+    });
 
     // Button signals - Use Qt::QueuedConnection to prevent double execution
     connect(m_sellProductsBtn, &QPushButton::clicked, this, &SalesDashboard::onSellProductsClicked, Qt::QueuedConnection);
     connect(m_clearSelectionBtn, &QPushButton::clicked, this, &SalesDashboard::onClearSelectionClicked, Qt::QueuedConnection);
     // connect(m_addQtyBtn, &QPushButton::clicked, [this](bool) { onQuantityChanged(true); }, Qt::QueuedConnection);
     // connect(m_removeQtyBtn, &QPushButton::clicked, [this](bool) { onQuantityChanged(false); }, Qt::QueuedConnection);
-
-
-    // SalesManager signals
-    connect(m_salesManager, &SalesManager::productSelectedFromWidget, this, &SalesDashboard::onProductSelectedFromWidget);
 }
 
 void SalesDashboard::refreshData()
 {
-    if (m_productsTable->isVisible()) m_productManager->loadProducts(m_productsTable);
-    if (m_salesTable->isVisible()) m_salesManager->loadSales(m_salesTable);
+    if (m_productsTable->isVisible()) m_productManager->loadProducts(m_productsModel);
+    if (m_salesTable->isVisible()) m_salesManager->loadSales(m_salesModel);
 }
 
 void SalesDashboard::clearLayout(QLayout *layout)
@@ -206,57 +226,64 @@ void SalesDashboard::clearLayout(QLayout *layout)
 
 void SalesDashboard::refreshProductList()
 {
-    clearLayout(m_recommendLayout);
+    m_recommendModel->clear();
     refreshData();
 }
 
 void SalesDashboard::refreshSalesTable()
 {
-    if (m_salesTable->isVisible()) m_salesManager->loadSales(m_salesTable);
+    if (m_salesTable->isVisible()) m_salesManager->loadSales(m_salesModel);
+}
+
+void SalesDashboard::refreshAfterSale()
+{
+    if (m_productsTable->isVisible()) m_productManager->loadProducts(m_productsModel);
+    m_salesManager->loadNewSales(m_salesModel); // No-op until the history has been loaded once
 }
 
 void SalesDashboard::resetSalesArea()
 {
-    m_selectedItems.clear();
-    m_selectedProductsTable->setRowCount(0);
+    m_cart->clear(); // Resets the total label through totalChanged
     clearLayout(m_selectedLayout);
-    m_totalAmount = 0.0;
-    m_totalLabel->setText("0.00 Rs.");
     m_currentSelectedRow = -1;
 }
 
-void SalesDashboard::onProductSearchTextChanged(const QString &text)
+quint64 SalesDashboard::searchProducts(const QString &text)
 {
-    clearLayout(m_recommendLayout);
-
-    if (text.isEmpty()) return;
+    if (text.isEmpty()) {
+        m_recommendModel->clear();
+        return 0;
+    }
 
-    // Use existing manager method for recommendations
-    m_salesManager->getProductsForRecommendation(m_recommendLayout, text);
+    m_salesManager->getProductsForRecommendation(m_recommendations, text);
+    m_recommendModel->setProducts(m_recommendations);
 
     // Update debug table if visible
     if (m_productsTable->isVisible()) {
-        m_productManager->searchProducts(m_productsTable, text);
+        return m_productManager->searchProducts(m_productsModel, text);
     }
+    return 0;
 }
 
-void SalesDashboard::onSalesSearchTextChanged(const QString &text)
+quint64 SalesDashboard::searchSales(const QString &text)
 {
     if (m_salesTable->isVisible()) {
-        m_salesManager->searchSales(m_salesTable, text);
+        return m_salesManager->searchSales(m_salesModel, text);
     }
+    return 0;
 }
 
-void SalesDashboard::onProductSelected(int row, int column)
+void SalesDashboard::onProductSelected(const QModelIndex &index)
 {
-    if (row < 0 || row >= m_productsTable->rowCount()) return;
+    if (!index.isValid() || index.row() >= m_productsModel->rowCount()) return;
 
+    const int row = index.row();
     SaleItem item;
-    item.productId = m_productsTable->item(row, 0)->text().toInt();
-    item.productName = m_productsTable->item(row, 1)->text();
-    item.unitPrice = m_productsTable->item(row, 2)->text().toDouble();
-    item.category = m_productsTable->item(row, 3)->text();
-    item.available = m_productsTable->item(row, 4)->text().toInt();
+    item.productId = static_cast<int>(m_productsModel->intValue(row, 0));
+    item.productName = m_productsModel->text(row, 1);
+    item.unitPrice = m_productsModel->realValue(row, 2);
+    item.category = m_productsModel->text(row, 3);
+    item.available = static_cast<int>(m_productsModel->intValue(row, 4));
     item.quantity = 1;
     item.totalPrice = item.unitPrice;
 
@@ -270,17 +297,19 @@ void SalesDashboard::onProductSelected(int row, int column)
     addProductToSelectedList(item);
 }
 
-void SalesDashboard::onProductSelectedFromWidget(int productId, QString productName, double price, QString category, int available)
+void SalesDashboard::onRecommendationClicked(const QModelIndex &index)
 {
-    // This method handles clicks from the recommendation widgets
+    const IndexedProduct *product = m_recommendModel->product(index.row());
+    if (!product) return;
+
     SaleItem item;
-    item.productId = productId;
-    item.productName = productName;
-    item.unitPrice = price;
-    item.category = category;
-    item.available = available;
+    item.productId = product->id;
+    item.productName = product->name;
+    item.unitPrice = product->price;
+    item.category = product->category;
+    item.available = product->quantity;
     item.quantity = 1;
-    item.totalPrice = price;
+    item.totalPrice = product->price;
 
     // Check stock before adding
     if (item.available <= 0) {
@@ -292,75 +321,54 @@ void SalesDashboard::onProductSelectedFromWidget(int productId, QString productN
     addProductToSelectedList(item);
 }
 
-void SalesDashboard::onSelectedProductClicked(int row, int column)
+void SalesDashboard::onCodeScanned()
 {
-    highlightSelectedProduct(row);
-}
+    QElapsedTimer timer;
+    timer.start();
 
-void SalesDashboard::highlightSelectedProduct(int row)
-{
-    // Clear previous highlight
-    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_selectedProductsTable->rowCount()) {
-        for (int col = 0; col < m_selectedProductsTable->columnCount(); col++) {
-            auto *item = m_selectedProductsTable->item(m_currentSelectedRow, col);
-            if (item) item->setBackground(Qt::transparent);
-        }
-    }
+    // Text that isn't a known SKU / barcode stays an ordinary search
+    SaleItem item;
+    if (!m_salesManager->lookupCode(m_productSearchEdit->text(), item)) return;
 
-    // Set new highlight
-    if (row >= 0 && row < m_selectedProductsTable->rowCount()) {
-        for (int col = 0; col < m_selectedProductsTable->columnCount(); col++) {
-            auto *item = m_selectedProductsTable->item(row, col);
-            if (item) item->setBackground(QColor("#436cfd"));
-        }
+    if (item.available <= 0) {
+        QMessageBox::warning(this, "Out of Stock",
+                             QString("Product '%1' is currently out of stock.").arg(item.productName));
+        return;
     }
 
+    addProductToSelectedList(item);
+    m_salesManager->scanLatency().record(timer.nsecsElapsed());
+    m_productSearchEdit->clear(); // Ready for the next scan
+}
+
+void SalesDashboard::onSelectedProductClicked(const QModelIndex &index)
+{
+    if (index.isValid()) highlightSelectedProduct(index.row());
+}
+
+void SalesDashboard::highlightSelectedProduct(int row)
+{
+    m_selectedProductsTable->selectRow(row);
     m_currentSelectedRow = row;
 }
 
 void SalesDashboard::addProductToSelectedList(const SaleItem &item)
 {
     // Check for existing product - if exists, increase quantity instead of duplicating
-    for (int i = 0; i < m_selectedItems.size(); i++) {
-        if (m_selectedItems[i].productId == item.productId) {
-            updateSelectedItemQuantity(i, true);
-            return;
-        }
+    const int existing = m_cart->indexOf(item.productId);
+    if (existing >= 0) {
+        updateSelectedItemQuantity(existing, true);
+        return;
     }
 
-    // Add new product
-    m_selectedItems.append(item);
-    int row = m_selectedProductsTable->rowCount();
-    m_selectedProductsTable->insertRow(row);
-
-    // Populate table row
-    m_selectedProductsTable->setItem(row, 0, new QTableWidgetItem(item.productName));
-    m_selectedProductsTable->setItem(row, 1, new QTableWidgetItem(QString::number(item.unitPrice, 'f', 2)));
-    m_selectedProductsTable->setItem(row, 2, new QTableWidgetItem(QString::number(item.quantity)));
-    m_selectedProductsTable->setItem(row, 3, new QTableWidgetItem(QString::number(item.totalPrice, 'f', 2)));
-
-    // Add remove button
-    auto *removeBtn = new QPushButton("X", this);
-    removeBtn->setCursor(Qt::PointingHandCursor);
-    removeBtn->setStyleSheet("background-color: #e74c3c; color: white; font-weight: bold;");
-
-    // Use a queued connection to prevent double execution
-    // connect(removeBtn, &QPushButton::clicked, [this, row]() {
-    //     removeProduct(row);
-    // }, Qt::QueuedConnection);
-
-    m_selectedProductsTable->setCellWidget(row, 4, removeBtn);
-
-    updateTotalAmount();
-    highlightSelectedProduct(row);
+    m_cart->append(item);
+    highlightSelectedProduct(m_cart->rowCount() - 1);
 }
 
 void SalesDashboard::removeProduct(int row)
 {
-    if (row >= 0 && row < m_selectedItems.size()) {
-        m_selectedItems.removeAt(row);
-        m_selectedProductsTable->removeRow(row);
-        updateTotalAmount();
+    if (row >= 0 && row < m_cart->rowCount()) {
+        m_cart->removeAt(row);
 
         // Update current selection tracking
         if (m_currentSelectedRow == row) {
@@ -373,52 +381,22 @@ void SalesDashboard::removeProduct(int row)
 
 void SalesDashboard::updateSelectedItemQuantity(int index, bool increase)
 {
-    if (index < 0 || index >= m_selectedItems.size()) return;
-
-    auto &item = m_selectedItems[index];
-
-    if (increase) {
-        if (item.quantity < item.available) {
-            item.quantity++;
-        } else {
-            QMessageBox::warning(this, "Insufficient Stock",
-                                 QString("Cannot add more of '%1'. Only %2 units available in stock.")
-                                     .arg(item.productName).arg(item.available));
-            return;
-        }
-    } else {
-        if (item.quantity > 1) {
-            item.quantity--;
-        } else {
-            if (item.quantity > 1) {
-                item.quantity--;
-            } else {
-                return;
-            }
-        }
-    }
-
-    item.totalPrice = item.quantity * item.unitPrice;
-
-    // Update table
-    m_selectedProductsTable->item(index, 2)->setText(QString::number(item.quantity));
-    m_selectedProductsTable->item(index, 3)->setText(QString::number(item.totalPrice, 'f', 2));
-
-    updateTotalAmount();
-}
-
-void SalesDashboard::updateTotalAmount()
-{
-    m_totalAmount = 0.0;
-    for (const auto &item : m_selectedItems) {
-        m_totalAmount += item.totalPrice;
+    if (index < 0 || index >= m_cart->rowCount()) return;
+
+    // Only this line's Qty and Total cells repaint
+    const SaleItem &item = m_cart->items().at(index);
+    if (increase && !m_cart->setQuantity(index, item.quantity + 1)) {
+        QMessageBox::warning(this, "Insufficient Stock",
+                             QString("Cannot add more of '%1'. Only %2 units available in stock.")
+                                 .arg(item.productName).arg(item.available));
+    } else if (!increase) {
+        m_cart->setQuantity(index, item.quantity - 1); // Refused below one
     }
-    m_totalLabel->setText(QString("%1 Rs.").arg(m_totalAmount, 0, 'f', 2));
 }
 
 void SalesDashboard::onQuantityChanged(bool increase)
 {
-    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_selectedItems.size()) {
+    if (m_currentSelectedRow >= 0 && m_currentSelectedRow < m_cart->rowCount()) {
         updateSelectedItemQuantity(m_currentSelectedRow, increase);
     }
 }
@@ -430,36 +408,13 @@ void SalesDashboard::onSellProductsClicked()
     if (processing) return;
     processing = true;
 
-    if (m_selectedItems.isEmpty()) {
+    if (m_cart->isEmpty()) {
         QMessageBox::warning(this, "No Products Selected",
                              "Please select at least one product to complete the sale.");
         processing = false;
         return;
     }
 
-    // Validate stock for all items before processing
-    for (const auto &item : m_selectedItems) {
-        QSqlQuery stockCheck;
-        stockCheck.prepare("SELECT quantity FROM Products WHERE product_id = ?");
-        stockCheck.addBindValue(item.productId);
-
-        if (!stockCheck.exec() || !stockCheck.next()) {
-            QMessageBox::critical(this, "Stock Check Failed",
-                                  QString("Failed to verify stock for product '%1'.").arg(item.productName));
-            processing = false;
-            return;
-        }
-
-        int availableStock = stockCheck.value(0).toInt();
-        if (availableStock < item.quantity) {
-            QMessageBox::warning(this, "Insufficient Stock",
-                                 QString("Product '%1' only has %2 units in stock, but you're trying to sell %3 units.")
-                                     .arg(item.productName).arg(availableStock).arg(item.quantity));
-            processing = false;
-            return;
-        }
-    }
-
     int userId = m_dbHandler->getCurrentUserId();
     if (userId <= 0) {
         QMessageBox::critical(this, "Authentication Error",
@@ -468,14 +423,21 @@ void SalesDashboard::onSellProductsClicked()
         return;
     }
 
-    if (m_salesManager->processSale(m_selectedItems, userId)) {
+    // Stock is checked atomically by processSale's decrement; there is no separate pre-check
+    QList<StockShortage> shortages;
+    int orderId = 0;
+    if (m_salesManager->processSale(m_cart->items(), userId, &shortages, &orderId)) {
         QMessageBox::information(this, "Sale Completed",
-                                 QString("Sale of %1 items totaling %2 Rs. has been successfully recorded.")
-                                     .arg(m_selectedItems.size())
-                                     .arg(m_totalAmount, 0, 'f', 2));
+                                 QString("Sale of %1 items totaling %2 Rs. has been successfully recorded.%3")
+                                     .arg(m_cart->rowCount())
+                                     .arg(m_cart->total(), 0, 'f', 2)
+                                     .arg(orderId > 0 ? QString("\nReceipt #%1").arg(orderId) : QString()));
         resetSalesArea();
-        refreshSalesTable();
-        refreshProductList(); // Refresh to update stock counts
+        // Its stock counts are stale; the product list and history reload through
+        // MainWindow's RefreshScheduler on salesUpdated
+        m_recommendModel->clear();
+    } else if (!shortages.isEmpty()) {
+        QMessageBox::warning(this, "Insufficient Stock", SalesManager::describeShortages(shortages));
     } else {
         QMessageBox::critical(this, "Sale Failed",
                               "There was an error processing the sale. Please try again.");
@@ -491,7 +453,7 @@ void SalesDashboard::onClearSelectionClicked()
     if (processing) return;
     processing = true;
 
-    if (m_selectedItems.isEmpty()) {
+    if (m_cart->isEmpty()) {
         processing = false;
         return;
     }
@@ -4,18 +4,26 @@
 
 #include <QWidget>
 #include <QLineEdit>
-#include <QTableWidget>
+#include <QTableView>
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QListView>
 #include <QList>
+#include <QVector>
 #include <QSqlQuery>
 #include "saleitem.h"
+#include "productindex.h"
 
 // Forward declarations
 class DatabaseHandler;
 class ProductManager;
 class SalesManager;
+class RowBufferModel;
+class SalesHistoryModel;
+class SearchController;
+class RecommendationModel;
+class CartModel;
 
 class SalesDashboard : public QWidget
 {
@@ -29,13 +37,14 @@ public:
     void refreshData();
     void refreshProductList();
     void refreshSalesTable();
+    void refreshAfterSale(); // Product stock and new history rows; run by MainWindow's RefreshScheduler
 
 private slots:
-    void onProductSearchTextChanged(const QString &text);
-    void onSalesSearchTextChanged(const QString &text);
-    void onProductSelected(int row, int column);
-    void onProductSelectedFromWidget(int productId, QString productName, double price, QString category, int available);
-    void onSelectedProductClicked(int row, int column);
+    void onProductSelected(const QModelIndex &index);
+    void onRecommendationClicked(const QModelIndex &index);
+    void onSelectedProductClicked(const QModelIndex &index);
+    void removeProduct(int row);
+    void onCodeScanned();
     void onSellProductsClicked();
     void onClearSelectionClicked();
     void onQuantityChanged(bool increase);
@@ -47,12 +56,12 @@ private:
     void setupRightPanel(QVBoxLayout *rightLayout);
     void setupControls(QVBoxLayout *rightLayout);
     void connectSignals();
+    quint64 searchProducts(const QString &text); // Worker request id, 0 if none
+    quint64 searchSales(const QString &text);
     void clearLayout(QLayout *layout);
     void resetSalesArea();
     void addProductToSelectedList(const SaleItem &item);
-    void removeProduct(int row);
     void updateSelectedItemQuantity(int index, bool increase);
-    void updateTotalAmount();
     void highlightSelectedProduct(int row);
 
     // Core components
@@ -63,14 +72,22 @@ private:
     // Search widgets
     QLineEdit *m_productSearchEdit;
     QLineEdit *m_salesSearchEdit;
+    SearchController *m_searchController;
 
     // Tables
-    QTableWidget *m_productsTable;
-    QTableWidget *m_salesTable;
-    QTableWidget *m_selectedProductsTable;
+    QTableView *m_productsTable;
+    QTableView *m_salesTable;
+    QTableView *m_selectedProductsTable;
+    CartModel *m_cart;
+    RowBufferModel *m_productsModel;
+    SalesHistoryModel *m_salesModel;
+
+    // Recommendations: one view and model reused for every search
+    QListView *m_recommendView;
+    RecommendationModel *m_recommendModel;
+    QVector<IndexedProduct> m_recommendations;
 
     // Layouts
-    QVBoxLayout *m_recommendLayout;
     QVBoxLayout *m_selectedLayout;
 
     // Controls
@@ -81,8 +98,6 @@ private:
     QLabel *m_totalLabel;
 
     // Data
-    QList<SaleItem> m_selectedItems;
-    double m_totalAmount;
     int m_currentSelectedRow;
 };
 
@@ -0,0 +1,184 @@
+#include "salesexporter.h"
+#include "connectionpool.h"
+#include <QSaveFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+
+namespace {
+const int kChunkRows = 10000;
+const int kWriteBufferBytes = 256 * 1024;
+
+const char *const kColumns = "sales_id, order_id, sale_date, salesman_id, product_id, product_name, "
+                             "category, price, quantity_sold, total_price";
+
+void appendField(QByteArray &buffer, const QVariant &value)
+{
+    if (value.isNull()) return;
+    QByteArray bytes = value.type() == QVariant::DateTime
+                           ? value.toDateTime().toString("yyyy-MM-dd HH:mm:ss").toUtf8()
+                           : value.toString().toUtf8(); // DECIMAL columns keep their exact text
+    if (bytes.contains(',') || bytes.contains('"') || bytes.contains('\n') || bytes.contains('\r')) {
+        bytes.replace("\"", "\"\"");
+        buffer.append('"').append(bytes).append('"');
+    } else {
+        buffer.append(bytes);
+    }
+}
+
+// Accumulates records and hands them to the file in large writes
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(QIODevice *device) : m_device(device) { m_buffer.reserve(kWriteBufferBytes + 4096); }
+
+    bool writeRecord(const QSqlQuery &query, int columns)
+    {
+        for (int i = 0; i < columns; ++i) {
+            if (i > 0) m_buffer.append(',');
+            appendField(m_buffer, query.value(i));
+        }
+        m_buffer.append("\r\n"); // RFC 4180 line ending; spreadsheet imports expect it
+        return m_buffer.size() < kWriteBufferBytes || flush();
+    }
+
+    bool writeLine(const QByteArray &line)
+    {
+        m_buffer.append(line).append("\r\n");
+        return true;
+    }
+
+    bool flush()
+    {
+        const bool ok = m_device->write(m_buffer) == m_buffer.size();
+        m_buffer.clear(); // Keeps its capacity
+        return ok;
+    }
+
+private:
+    QIODevice *m_device;
+    QByteArray m_buffer;
+};
+}
+
+SalesExporter::SalesExporter(ConnectionPool *pool, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_cancelled(false)
+{
+    connect(&m_watcher, &QFutureWatcher<ExportReport>::finished, this, &SalesExporter::onFinished);
+}
+
+SalesExporter::~SalesExporter()
+{
+    m_cancelled = true;
+    m_watcher.waitForFinished(); // The export holds a pooled connection
+}
+
+bool SalesExporter::start(const QString &path, const QDate &from, const QDate &to)
+{
+    if (m_watcher.isRunning()) return false;
+    m_cancelled = false;
+    m_watcher.setFuture(QtConcurrent::run([this, path, from, to]() { return run(path, from, to); }));
+    return true;
+}
+
+void SalesExporter::cancel()
+{
+    m_cancelled = true;
+}
+
+void SalesExporter::onFinished()
+{
+    const ExportReport report = m_watcher.result();
+    qDebug() << "Sales export:" << report.rows << "rows in" << report.elapsedMs << "ms"
+             << (report.cancelled ? "(cancelled)" : "");
+    emit finished(report);
+}
+
+ExportReport SalesExporter::run(const QString &path, const QDate &from, const QDate &to)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ExportReport report;
+    report.path = path;
+    auto fail = [&report, &timer](const QString &error) {
+        report.error = error;
+        report.elapsedMs = timer.elapsed();
+        return report;
+    };
+
+    PooledConnection connection(m_pool, 10000);
+    if (!connection.isValid()) return fail("No database connection available");
+    QSqlDatabase db = connection.database();
+
+    // Only for the progress bar; counted over the same index range the chunks walk
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT COUNT(*) FROM Sales WHERE sale_date >= ? AND sale_date < ?");
+    query.addBindValue(from);
+    query.addBindValue(to.addDays(1));
+    if (!query.exec() || !query.next()) return fail("Failed to count sales: " + query.lastError().text());
+    const qint64 totalRows = query.value(0).toLongLong();
+
+    // Written beside the target and renamed over it on commit, so a failed or cancelled export
+    // never leaves a truncated file behind
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return fail("Cannot write " + path + ": " + file.errorString());
+    BufferedWriter writer(&file);
+    writer.writeLine(QByteArray(kColumns).replace(" ", ""));
+
+    const QString select = QString("SELECT %1 FROM Sales WHERE sale_date >= ? AND sale_date < ?").arg(kColumns);
+    const QString first = select + " ORDER BY sale_date, sales_id LIMIT ?";
+    const QString next = select + " AND (sale_date > ? OR (sale_date = ? AND sales_id > ?))"
+                                  " ORDER BY sale_date, sales_id LIMIT ?";
+    QVariant lastSalesId;
+    QVariant lastSaleDate;
+    int columns = 0;
+    for (;;) {
+        if (m_cancelled) {
+            file.cancelWriting();
+            report.cancelled = true;
+            report.elapsedMs = timer.elapsed();
+            return report;
+        }
+
+        query.prepare(lastSalesId.isValid() ? next : first);
+        query.addBindValue(from);
+        query.addBindValue(to.addDays(1));
+        if (lastSalesId.isValid()) {
+            query.addBindValue(lastSaleDate);
+            query.addBindValue(lastSaleDate);
+            query.addBindValue(lastSalesId);
+        }
+        query.addBindValue(kChunkRows);
+        if (!query.exec()) {
+            file.cancelWriting();
+            return fail("Failed to read sales: " + query.lastError().text());
+        }
+        if (columns == 0) columns = query.record().count();
+
+        int rows = 0;
+        while (query.next()) {
+            if (!writer.writeRecord(query, columns)) {
+                file.cancelWriting();
+                return fail("Failed to write " + path + ": " + file.errorString());
+            }
+            lastSalesId = query.value(0);
+            lastSaleDate = query.value(2);
+            ++rows;
+        }
+        query.finish(); // Frees the result set before the next chunk
+        report.rows += rows;
+        emit progress(report.rows, totalRows);
+        if (rows < kChunkRows) break;
+    }
+
+    if (!writer.flush() || !file.commit()) return fail("Failed to write " + path + ": " + file.errorString());
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
@@ -0,0 +1,52 @@
+#ifndef SALESEXPORTER_H
+#define SALESEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QDate>
+#include <QFutureWatcher>
+#include <atomic>
+
+class ConnectionPool;
+
+struct ExportReport {
+    qint64 rows = 0;
+    qint64 elapsedMs = 0;
+    bool cancelled = false; // Nothing is written: the target file is only replaced on success
+    QString error;
+    QString path;
+};
+
+// Writes the sales lines dated from..to (inclusive) to a CSV file for the accountants. Lines
+// are read in fixed-size chunks, each a forward-only keyset query on (sale_date, sales_id)
+// served by idx_sales_date_id, and go through a bounded write buffer, so memory stays flat
+// however many rows the range holds. Runs on a pooled connection off the GUI thread.
+class SalesExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SalesExporter(ConnectionPool *pool, QObject *parent = nullptr);
+    ~SalesExporter();
+
+    bool start(const QString &path, const QDate &from, const QDate &to); // False if one is running
+    void cancel();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+signals:
+    // Emitted from the export thread once per chunk; connect with the default (queued) type
+    void progress(qint64 rowsWritten, qint64 totalRows);
+    void finished(const ExportReport &report);
+
+private slots:
+    void onFinished();
+
+private:
+    ExportReport run(const QString &path, const QDate &from, const QDate &to);
+
+    ConnectionPool *m_pool;
+    std::atomic_bool m_cancelled;
+    QFutureWatcher<ExportReport> m_watcher;
+};
+
+#endif // SALESEXPORTER_H
@@ -0,0 +1,162 @@
+#include "saleshistorymodel.h"
+#include "databasehandler.h"
+#include <QDebug>
+
+namespace {
+const int kDefaultPageSize = 200;
+
+const char *const kSalesColumns =
+    "SELECT sales_id, salesman_id, product_id, product_name, price, "
+    "category, quantity_sold, sale_date, total_price FROM Sales";
+}
+
+SalesHistoryModel::SalesHistoryModel(const QStringList &headers, DatabaseHandler *dbHandler, QObject *parent)
+    : RowBufferModel(describe(headers, {
+          Integer, Integer, Integer, Text, Real, Text, Integer, DateTime}), parent)
+    , m_dbHandler(dbHandler)
+    , m_pageSize(kDefaultPageSize)
+    , m_pendingRequest(0)
+    , m_atEnd(true)
+    , m_loaded(false)
+    , m_newestSalesId(-1)
+    , m_pendingNewer(0)
+    , m_newerQueued(false)
+{
+    connect(m_dbHandler->worker(), &DatabaseWorker::queryFinished, this, &SalesHistoryModel::onQueryFinished);
+}
+
+bool SalesHistoryModel::reload(const QString &filter, DatabaseWorker::Priority priority)
+{
+    beginResetModel();
+    clearBuffers();
+    endResetModel();
+
+    m_filter = filter;
+    m_lastSaleDate.clear();
+    m_lastSalesId.clear();
+    m_atEnd = false;
+    m_loaded = true;
+    m_newestSalesId = -1;
+    m_pendingRequest = 0; // Any page or delta still in flight belongs to the old listing
+    m_pendingNewer = 0;
+    m_newerQueued = false;
+    return requestPage(priority);
+}
+
+bool SalesHistoryModel::fetchNewer()
+{
+    if (!m_loaded) return true; // Nothing shown yet; the first reload will include the new rows
+
+    // A delta or first page in flight may have run before the latest commit, so go again once it lands
+    if (m_pendingNewer != 0 || m_newestSalesId < 0) {
+        m_newerQueued = true;
+        return true;
+    }
+    if (!m_dbHandler->isConnected()) {
+        qDebug() << "Database not connected";
+        return false;
+    }
+
+    QVariantList params;
+    const QString sql = buildQuery({"sales_id > ?"}, params);
+    params.prepend(m_newestSalesId);
+    m_pendingNewer = m_dbHandler->worker()->submit(sql, params, DatabaseWorker::Normal);
+    return true;
+}
+
+void SalesHistoryModel::setPageSize(int pageSize)
+{
+    m_pageSize = qMax(1, pageSize);
+}
+
+bool SalesHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_atEnd && m_pendingRequest == 0 && m_rowCount > 0;
+}
+
+void SalesHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (canFetchMore(parent)) requestPage(DatabaseWorker::Normal);
+}
+
+bool SalesHistoryModel::requestPage(DatabaseWorker::Priority priority)
+{
+    if (!m_dbHandler->isConnected()) {
+        qDebug() << "Database not connected";
+        return false;
+    }
+
+    QStringList conditions;
+    QVariantList cursorParams;
+    if (m_lastSalesId.isValid()) {
+        // Rows strictly after the cursor in (sale_date DESC, sales_id DESC) order
+        conditions << "(sale_date < ? OR (sale_date = ? AND sales_id < ?))";
+        cursorParams << m_lastSaleDate << m_lastSaleDate << m_lastSalesId;
+    }
+
+    QVariantList params;
+    const QString sql = buildQuery(conditions, params) + " LIMIT ?";
+    params = cursorParams + params;
+    params << m_pageSize;
+
+    m_pendingRequest = m_dbHandler->worker()->submit(sql, params, priority);
+    return true;
+}
+
+QString SalesHistoryModel::buildQuery(const QStringList &extraConditions, QVariantList &params) const
+{
+    // Extra conditions come first so their placeholders precede the filter's
+    QStringList conditions = extraConditions;
+    if (!m_filter.isEmpty()) {
+        const QString pattern = "%" + m_filter + "%";
+        conditions << "(product_name LIKE ? OR category LIKE ? OR sales_id LIKE ? OR product_id LIKE ?)";
+        params << pattern << pattern << pattern << pattern;
+    }
+
+    QString sql = kSalesColumns;
+    if (!conditions.isEmpty()) sql += " WHERE " + conditions.join(" AND ");
+    return sql + " ORDER BY sale_date DESC, sales_id DESC";
+}
+
+void SalesHistoryModel::onQueryFinished(quint64 requestId, const DbResult &result)
+{
+    if (requestId == 0) return;
+
+    if (requestId == m_pendingNewer) {
+        m_pendingNewer = 0;
+        if (result.cancelled) {
+            m_newerQueued = true; // Still owed; re-issued below
+        } else if (!result.ok) {
+            qDebug() << "Failed to fetch new sales:" << result.error;
+        } else {
+            for (const auto &row : result.rows) m_newestSalesId = qMax(m_newestSalesId, row.value(0).toLongLong());
+            prependRows(result);
+        }
+    } else if (requestId == m_pendingRequest) {
+        m_pendingRequest = 0;
+        if (!result.ok) {
+            if (!result.cancelled) qDebug() << "Failed to fetch sales page:" << result.error;
+            return;
+        }
+
+        const bool firstPage = m_newestSalesId < 0;
+        if (firstPage) m_newestSalesId = 0;
+        m_atEnd = result.rows.size() < m_pageSize;
+        if (!result.rows.isEmpty()) {
+            const QVariantList &last = result.rows.last();
+            m_lastSalesId = last.value(0);
+            m_lastSaleDate = last.value(7);
+            if (firstPage) {
+                for (const auto &row : result.rows) m_newestSalesId = qMax(m_newestSalesId, row.value(0).toLongLong());
+            }
+        }
+        appendRows(result);
+    } else {
+        return; // Not ours, or from a listing that was reloaded since
+    }
+
+    if (m_newerQueued && m_pendingNewer == 0 && m_newestSalesId >= 0) {
+        m_newerQueued = false;
+        fetchNewer();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SALESHISTORYMODEL_H
+#define SALESHISTORYMODEL_H
+
+#include "rowbuffermodel.h"
+#include "databaseworker.h"
+
+class DatabaseHandler;
+
+// Sales history paged with a keyset cursor on (sale_date, sales_id), newest first. Only the first
+// page is queried on reload; views pull further pages through canFetchMore()/fetchMore() as the
+// user scrolls, so opening the history costs one LIMITed query however large Sales grows.
+class SalesHistoryModel : public RowBufferModel
+{
+    Q_OBJECT
+
+public:
+    explicit SalesHistoryModel(const QStringList &headers, DatabaseHandler *dbHandler,
+                               QObject *parent = nullptr);
+
+    // Drop loaded rows and fetch the first page, optionally filtered by a search string
+    bool reload(const QString &filter = QString(),
+                DatabaseWorker::Priority priority = DatabaseWorker::Background);
+
+    // Prepend sales recorded since the newest loaded row (sales_id > newest) instead of reloading
+    bool fetchNewer();
+
+    void setPageSize(int pageSize);
+    int pageSize() const { return m_pageSize; }
+    quint64 pendingRequest() const { return m_pendingRequest; } // Page in flight, 0 if none
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private slots:
+    void onQueryFinished(quint64 requestId, const DbResult &result);
+
+private:
+    bool requestPage(DatabaseWorker::Priority priority);
+    QString buildQuery(const QStringList &extraConditions, QVariantList &params) const;
+
+    DatabaseHandler *m_dbHandler;
+    int m_pageSize;
+    QString m_filter;
+    quint64 m_pendingRequest; // 0 when no page is in flight
+    bool m_atEnd;
+    bool m_loaded;
+
+    // Delta fetch state; -1 until the first page has arrived
+    qint64 m_newestSalesId;
+    quint64 m_pendingNewer;
+    bool m_newerQueued;
+
+    // Keyset cursor: sort key of the last loaded row
+    QVariant m_lastSaleDate;
+    QVariant m_lastSalesId;
+};
+
+#endif // SALESHISTORYMODEL_H
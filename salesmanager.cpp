@@ -1,48 +1,96 @@
 #include "salesmanager.h"
-#include "clickableWidget.h"
+#include "rowreader.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 #include <QDateTime>
-#include <QVBoxLayout>
-#include <QHBoxLayout>
-#include <QLabel>
-#include <QPushButton>
-#include <QMessageBox>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QUuid>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 #include "DatabaseHandler.h"
 
+namespace {
+// A commit slower than this sends the following sales to the journal until replay catches up.
+// The main connection's driver timeouts match, so a dead server can't hold a sale much longer.
+const qint64 kSlowCommitMs = SqlDialect::kInteractiveTimeoutSecs * 1000;
+const int kReplayIntervalMs = 10000;
+const int kReplayBatchSize = 50;
+
+// "?, ?, ?" for one row of bind values
+QString placeholderRow(int columns)
+{
+    QStringList marks;
+    for (int i = 0; i < columns; ++i) marks.append("?");
+    return marks.join(", ");
+}
+
+// Derived table of (product_id, qty) bind pairs, joined by the set-based stock updates
+QString unitsTable(int rows)
+{
+    QStringList selects{"SELECT ? AS product_id, ? AS qty"};
+    for (int i = 1; i < rows; ++i) selects.append("SELECT ?, ?");
+    return selects.join(" UNION ALL ");
+}
+}
+
 SalesManager::SalesManager(DatabaseHandler *dbHandler, QObject *parent)
-    : QObject(parent), m_dbHandler(dbHandler)
+    : QObject(parent)
+    , m_dbHandler(dbHandler)
+    , m_journal(SaleJournal::defaultPath())
+    , m_offline(false)
+    , m_mainConnectionLost(false)
+    , m_exporter(new SalesExporter(dbHandler->pool(), this))
 {
+    connect(m_exporter, &SalesExporter::progress, this, &SalesManager::exportProgress);
+    connect(m_exporter, &SalesExporter::finished, this, &SalesManager::exportFinished);
+    m_replayTimer.setInterval(kReplayIntervalMs);
+    connect(&m_replayTimer, &QTimer::timeout, this, &SalesManager::replayJournal);
+    connect(&m_replayWatcher, &QFutureWatcher<ReplayResult>::finished, this, &SalesManager::onReplayFinished);
+    if (m_journal.pendingCount() > 0) m_replayTimer.start(); // Left over from a previous run
 }
 
-bool SalesManager::loadSales(QTableWidget *tableWidget)
+SalesManager::~SalesManager()
 {
-    return executeSalesQuery(tableWidget,
-                             "SELECT sales_id, salesman_id, product_id, product_name, price, "
-                             "category, quantity_sold, sale_date, total_price "
-                             "FROM Sales ORDER BY sale_date DESC");
+    m_replayTimer.stop();
+    m_replayWatcher.waitForFinished(); // The replay holds a pooled connection and uses this
 }
 
-void SalesManager::searchSales(QTableWidget *tableWidget, const QString &searchText)
+SalesHistoryModel *SalesManager::createSalesModel(const QStringList &headers, QObject *parent) const
 {
-    QSqlQuery query;
-    query.prepare("SELECT sales_id, salesman_id, product_id, product_name, price, "
-                  "category, quantity_sold, sale_date, total_price "
-                  "FROM Sales WHERE product_name LIKE :search OR category LIKE :search "
-                  "OR sales_id LIKE :search OR product_id LIKE :search "
-                  "ORDER BY sale_date DESC");
-    query.bindValue(":search", "%" + searchText + "%");
+    return new SalesHistoryModel(headers, m_dbHandler, parent);
+}
+
+RowBufferModel *SalesManager::createProductModel(const QStringList &headers, QObject *parent)
+{
+    return new RowBufferModel(RowBufferModel::describe(headers, {
+        RowBufferModel::Integer, RowBufferModel::Text, RowBufferModel::Real,
+        RowBufferModel::Text, RowBufferModel::Integer}), parent);
+}
 
-    executeSalesQuery(tableWidget, query);
+bool SalesManager::loadSales(SalesHistoryModel *model)
+{
+    return model && model->reload();
+}
+
+quint64 SalesManager::searchSales(SalesHistoryModel *model, const QString &searchText)
+{
+    return model && model->reload(searchText, DatabaseWorker::Interactive) ? model->pendingRequest() : 0;
 }
 
-bool SalesManager::searchProducts(QTableWidget *tableWidget, const QString &searchText)
+bool SalesManager::loadNewSales(SalesHistoryModel *model)
+{
+    return model && model->fetchNewer();
+}
+
+bool SalesManager::searchProducts(RowBufferModel *model, const QString &searchText)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    tableWidget->setRowCount(0);
     QSqlQuery query;
+    query.setForwardOnly(true);
     query.prepare("SELECT product_id, product_name, price, category, quantity "
                   "FROM Products WHERE product_name LIKE :search OR category LIKE :search "
                   "ORDER BY product_name");
@@ -53,193 +101,447 @@ bool SalesManager::searchProducts(QTableWidget *tableWidget, const QString &sear
         return false;
     }
 
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
-        for (int col = 0; col < 5; col++) {
-            tableWidget->setItem(row, col, new QTableWidgetItem(query.value(col).toString()));
-        }
-        row++;
-    }
-
-    return true;
+    return model->setRows(query);
 }
 
 bool SalesManager::getProductInfo(int productId, SaleItem &item)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query;
-    query.prepare("SELECT product_id, product_name, price, category, quantity "
-                  "FROM Products WHERE product_id = :product_id");
-    query.bindValue(":product_id", productId);
+    CachedQuery cached = m_dbHandler->cachedQuery("SELECT product_id, product_name, price, category, quantity "
+                                                 "FROM Products WHERE product_id = ?");
+    if (!cached) return false;
 
-    if (!query.exec() || !query.next()) {
+    QSqlQuery &query = *cached;
+    query.addBindValue(productId);
+
+    RowReader row(query);
+    if (!query.exec() || !row.next()) {
         qDebug() << "Failed to get product info:" << query.lastError().text();
         return false;
     }
 
-    item.productId = query.value(0).toInt();
-    item.productName = query.value(1).toString();
-    item.unitPrice = query.value(2).toDouble();
-    item.category = query.value(3).toString();
-    item.available = query.value(4).toInt();
+    item.productId = row.toInt(0);
+    item.productName = row.toString(1);
+    item.unitPrice = row.toDouble(2);
+    item.category = row.toString(3);
+    item.available = row.toInt(4);
     item.quantity = 1;
     item.totalPrice = item.unitPrice;
 
     return true;
 }
 
-bool SalesManager::getProductsForRecommendation(QVBoxLayout *layout, const QString &searchText)
+bool SalesManager::getProductsForRecommendation(QVector<IndexedProduct> &products, const QString &searchText)
 {
-    if (!m_dbHandler->isConnected() || !layout) return false;
+    products.clear(); // Keeps its capacity for the next keystroke
+    if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query;
-    query.prepare("SELECT product_id, product_name, price, category, quantity "
-                  "FROM Products WHERE product_name LIKE :search AND quantity > 0 "
-                  "ORDER BY product_name LIMIT 10");
-    query.bindValue(":search", "%" + searchText + "%");
+    // Served from memory once the index is built; typos still find near misses
+    ProductIndex *index = m_dbHandler->productIndex();
+    if (index->isBuilt()) {
+        for (const int productId : index->search(searchText, 10, true, true)) {
+            const IndexedProduct *product = index->product(productId);
+            if (product && product->quantity > 0) products.append(*product);
+        }
+        return true;
+    }
+
+    CachedQuery cached = m_dbHandler->cachedQuery("SELECT product_id, product_name, price, category, quantity "
+                                                 "FROM Products WHERE product_name LIKE ? AND quantity > 0 "
+                                                 "ORDER BY product_name LIMIT 10");
+    if (!cached) return false;
+
+    QSqlQuery &query = *cached;
+    query.addBindValue("%" + searchText + "%");
 
     if (!query.exec()) {
         qDebug() << "Failed to get recommendations:" << query.lastError().text();
         return false;
     }
 
-    while (query.next()) {
-        createProductWidget(layout, query);
+    RowReader rows(query);
+    while (rows.next()) {
+        IndexedProduct product;
+        product.id = rows.toInt(0);
+        product.name = rows.toString(1);
+        product.price = rows.toDouble(2);
+        product.category = rows.toString(3);
+        product.quantity = rows.toInt(4);
+        products.append(product);
     }
 
     return true;
 }
 
-void SalesManager::createProductWidget(QVBoxLayout *layout, const QSqlQuery &query)
+bool SalesManager::lookupCode(const QString &code, SaleItem &item) const
 {
-    int productId = query.value(0).toInt();
-    QString name = query.value(1).toString();
-    double price = query.value(2).toDouble();
-    QString category = query.value(3).toString();
-    int quantity = query.value(4).toInt();
-
-    // Don't create widgets for out-of-stock products
-    if (quantity <= 0) return;
-
-    auto *productWidget = new ClickableWidget(layout->parentWidget());
-    productWidget->setObjectName(QString("product_%1").arg(productId));
-    productWidget->setStyleSheet("background-color: #1e1e1e; color: white; border-radius: 5px; margin: 2px; padding: 5px;");
-    productWidget->setCursor(Qt::PointingHandCursor);
-
-    auto *productLayout = new QHBoxLayout(productWidget);
-    productLayout->setContentsMargins(10, 5, 10, 5);
-
-    auto *infoLayout = new QVBoxLayout();
-    auto *nameLabel = new QLabel(name, productWidget);
-    nameLabel->setStyleSheet("font-size: 14px; font-weight: bold;");
-    auto *unitLabel = new QLabel(QString("Stock: %1 | %2 Rs./Unit").arg(quantity).arg(price, 0, 'f', 2), productWidget);
-    unitLabel->setStyleSheet("font-size: 12px; color: #aaa;");
-
-    infoLayout->addWidget(nameLabel);
-    infoLayout->addWidget(unitLabel);
-
-    auto *priceLabel = new QLabel(QString("%1 Rs.").arg(price, 0, 'f', 2), productWidget);
-    priceLabel->setStyleSheet("font-size: 14px; font-weight: bold;");
-    priceLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-
-    productLayout->addLayout(infoLayout);
-    productLayout->addStretch();
-    productLayout->addWidget(priceLabel);
-
-    // Store product data as properties
-    productWidget->setProperty("productId", productId);
-    productWidget->setProperty("productName", name);
-    productWidget->setProperty("unitPrice", price);
-    productWidget->setProperty("category", category);
-    productWidget->setProperty("available", quantity);
-
-    // Connect the click signal to emit productSelected
-    connect(productWidget, &ClickableWidget::clicked, [this, productId, name, price, category, quantity]() {
-        // Validate stock before emitting
-        if (quantity > 0) {
-            emit productSelectedFromWidget(productId, name, price, category, quantity);
-        } else {
-            // Show warning for out of stock
-            QMessageBox::warning(nullptr, "Out of Stock",
-                                 QString("Product '%1' is currently out of stock.").arg(name));
-        }
-    });
+    const IndexedProduct *product = m_dbHandler->productIndex()->productByCode(code);
+    if (!product) return false;
+
+    item.productId = product->id;
+    item.productName = product->name;
+    item.unitPrice = product->price;
+    item.category = product->category;
+    item.available = product->quantity;
+    item.quantity = 1;
+    item.totalPrice = product->price;
+    return true;
+}
 
-    layout->addWidget(productWidget);
+bool SalesManager::processSale(const QList<SaleItem> &items, int userId, QList<StockShortage> *shortages,
+                               int *orderId)
+{
+    if (items.isEmpty()) return false;
+    if (orderId) *orderId = 0;
+
+    // While the database is down or slow, sales go to the local journal so the till keeps selling
+    if (!m_dbHandler->isConnected()) m_offline = m_mainConnectionLost = true; // Reopened by the replay timer
+    if (m_offline) return journalSale(items, userId);
+
+    QElapsedTimer timer;
+    timer.start();
+    double revenue = 0.0;
+    int units = 0;
+    int newOrderId = 0;
+    const WriteOutcome outcome = writeSale(QSqlDatabase::database(), items, userId, QString(), QDateTime(), false,
+                                           shortages, revenue, units, newOrderId);
+    if (outcome == ConnectionLost) {
+        qDebug() << "Database unreachable; journaling sale";
+        m_offline = true;
+        m_mainConnectionLost = true;
+        return journalSale(items, userId);
+    }
+    if (outcome != Committed) return false;
+
+    if (timer.elapsed() > kSlowCommitMs) {
+        qDebug() << "Sale commit took" << timer.elapsed() << "ms; journaling until the database catches up";
+        m_offline = true;
+        if (!m_replayTimer.isActive()) m_replayTimer.start();
+    }
+
+    if (orderId) *orderId = newOrderId;
+    m_dbHandler->counters()->addSales(1, revenue, units);
+    for (const auto &item : items) m_dbHandler->productIndex()->adjustQuantity(item.productId, -item.quantity);
+    emit salesUpdated();
+    return true;
 }
 
-bool SalesManager::processSale(const QList<SaleItem> &items, int userId)
+bool SalesManager::journalSale(const QList<SaleItem> &items, int userId)
 {
-    if (!m_dbHandler->isConnected()) return false;
+    JournaledSale sale;
+    sale.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    sale.userId = userId;
+    sale.createdAt = QDateTime::currentDateTime();
+    sale.items = items;
+    if (!m_journal.append(sale)) return false; // Disk failure: the sale really didn't happen
+
+    // The index shows what is left on the shelf; the database catches up on replay
+    for (const auto &item : items) m_dbHandler->productIndex()->adjustQuantity(item.productId, -item.quantity);
+    emit journalChanged(m_journal.pendingCount());
+    if (!m_replayTimer.isActive()) m_replayTimer.start();
+    return true;
+}
 
-    // Validate all items have stock before processing
-    for (const auto &item : items) {
-        QSqlQuery stockCheck;
-        stockCheck.prepare("SELECT quantity FROM Products WHERE product_id = ?");
-        stockCheck.addBindValue(item.productId);
+void SalesManager::replayJournal()
+{
+    if (m_replayWatcher.isRunning()) return;
+    if (m_journal.pendingCount() == 0 && !m_mainConnectionLost) {
+        onJournalDrained();
+        return;
+    }
+    // Runs even with nothing to replay while the default connection is down: checking out a
+    // pooled connection off the GUI thread is how a tick finds out the server is back
+    m_replayWatcher.setFuture(QtConcurrent::run([this]() { return replayBatch(); }));
+}
 
-        if (!stockCheck.exec() || !stockCheck.next()) {
-            qDebug() << "Failed to check stock for product:" << item.productId;
-            return false;
+SalesManager::ReplayResult SalesManager::replayBatch()
+{
+    // Pool thread. Journal and statement cache are thread-safe; nothing else here touches GUI state.
+    ReplayResult result;
+    PooledConnection connection(m_dbHandler->pool(), 1000);
+    if (!connection.isValid()) return result; // Still unreachable
+
+    QSqlDatabase db = connection.database();
+    result.reachable = true; // Until a write says otherwise
+
+    for (const JournaledSale &sale : m_journal.pending(kReplayBatchSize)) {
+        double revenue = 0.0;
+        int units = 0;
+        int orderId = 0;
+        QList<StockShortage> shortages;
+        WriteOutcome outcome = writeSale(db, sale.items, sale.userId, sale.id, sale.createdAt, false, &shortages,
+                                         revenue, units, orderId);
+        if (outcome == Shortage) {
+            // The goods already left the shop; record the sale and flag the stock for a recount
+            outcome = writeSale(db, sale.items, sale.userId, sale.id, sale.createdAt, true, nullptr, revenue, units,
+                                orderId);
+            if (outcome == Committed) {
+                result.conflicts.append(QString("Offline sale from %1 oversold stock. %2")
+                                            .arg(sale.createdAt.toString("yyyy-MM-dd hh:mm"), describeShortages(shortages)));
+            }
         }
 
-        int availableStock = stockCheck.value(0).toInt();
-        if (availableStock < item.quantity) {
-            QMessageBox::warning(nullptr, "Insufficient Stock",
-                                 QString("Product '%1' only has %2 units in stock, but you're trying to sell %3 units.")
-                                     .arg(item.productName).arg(availableStock).arg(item.quantity));
-            return false;
+        switch (outcome) {
+        case Committed:
+            result.revenue += revenue;
+            result.units += units;
+            ++result.applied;
+            m_journal.markApplied(sale.id);
+            break;
+        case AlreadyApplied:
+            m_journal.markApplied(sale.id);
+            break;
+        case ConnectionLost:
+            result.reachable = false; // Lost again mid-batch; the rest waits for the next tick
+            return result;
+        case Retry:
+            result.deferred = true; // Kept in order: this sale and the rest wait for the next tick
+            return result;
+        default:
+            m_journal.markRejected(sale.id, "The database refused the sale during replay");
+            result.conflicts.append(QString("Offline sale from %1 could not be recorded; it was saved to %2")
+                                        .arg(sale.createdAt.toString("yyyy-MM-dd hh:mm"), m_journal.rejectsPath()));
+            break;
         }
     }
+    return result;
+}
 
-    QSqlDatabase db = QSqlDatabase::database();
-    db.transaction();
+void SalesManager::onReplayFinished()
+{
+    const ReplayResult result = m_replayWatcher.result();
+    if (result.applied > 0) {
+        qDebug() << "Replayed" << result.applied << "journaled sales";
+        m_dbHandler->counters()->addSales(result.applied, result.revenue, result.units);
+        m_dbHandler->productIndex()->rebuild(); // Forced replays may have clamped stock
+        emit salesUpdated();
+    }
+    if (!result.conflicts.isEmpty()) emit journalConflicts(result.conflicts);
+    if (!result.reachable) return; // Retried on the next tick
+
+    // A pooled connection reached the server just now, so reopening the default one won't sit
+    // out the connect timeout on the GUI thread; if the server flapped again, the next tick retries
+    if (m_mainConnectionLost && m_dbHandler->reconnect()) m_mainConnectionLost = false;
+    if (result.deferred) return;
+
+    const int pending = m_journal.pendingCount();
+    emit journalChanged(pending);
+    if (pending > 0) {
+        QTimer::singleShot(0, this, &SalesManager::replayJournal); // Keep draining while it's up
+    } else {
+        onJournalDrained();
+    }
+}
 
-    QSqlQuery saleQuery, updateQuery;
-    saleQuery.prepare("INSERT INTO Sales (salesman_id, product_id, product_name, price, category, "
-                      "quantity_sold, total_price) VALUES (?, ?, ?, ?, ?, ?, ?)");
-    updateQuery.prepare("UPDATE Products SET quantity = quantity - ? WHERE product_id = ?");
+void SalesManager::onJournalDrained()
+{
+    // The default connection died with the outage; until a replay reopens it the timer keeps running
+    if (m_mainConnectionLost) return;
+    if (m_offline) qDebug() << "Sale journal drained; committing sales directly again";
+    m_offline = false;
+    m_replayTimer.stop();
+}
 
+SalesManager::WriteOutcome SalesManager::writeSale(QSqlDatabase db, const QList<SaleItem> &items, int userId,
+                                                   const QString &journalId, const QDateTime &soldAt,
+                                                   bool forceStock, QList<StockShortage> *shortages,
+                                                   double &revenue, int &units, int &orderId)
+{
+    // Units per product; the same product may appear on more than one line
+    QMap<int, int> unitsByProduct;
+    revenue = 0.0;
+    units = 0;
     for (const auto &item : items) {
-        saleQuery.addBindValue(userId);
-        saleQuery.addBindValue(item.productId);
-        saleQuery.addBindValue(item.productName);
-        saleQuery.addBindValue(item.unitPrice);
-        saleQuery.addBindValue(item.category);
-        saleQuery.addBindValue(item.quantity);
-        saleQuery.addBindValue(item.totalPrice);
-
-        if (!saleQuery.exec()) {
-            qDebug() << "Failed to process sale:" << saleQuery.lastError().text();
-            db.rollback();
-            return false;
+        if (item.quantity <= 0) {
+            qDebug() << "Refusing sale line with quantity" << item.quantity << "for product" << item.productId;
+            return Failed;
         }
+        unitsByProduct[item.productId] += item.quantity;
+        revenue += item.totalPrice;
+        units += item.quantity;
+    }
 
-        updateQuery.addBindValue(item.quantity);
-        updateQuery.addBindValue(item.productId);
-
-        if (!updateQuery.exec()) {
-            qDebug() << "Failed to update inventory:" << updateQuery.lastError().text();
-            db.rollback();
-            return false;
+    // Every statement below covers the whole basket, so the round trips don't grow with it.
+    // Their text depends on the basket size, so they are prepared per sale instead of cached.
+    auto bindUnits = [&unitsByProduct](QSqlQuery &query) {
+        for (auto it = unitsByProduct.constBegin(); it != unitsByProduct.constEnd(); ++it) {
+            query.addBindValue(it.key());
+            query.addBindValue(it.value());
+        }
+    };
+    const QString soldTable = "(" + unitsTable(unitsByProduct.size()) + ") s";
+
+    // A statement that fails because the server went away, or lost a deadlock or lock wait,
+    // rolled nothing forward; only the remaining errors would fail the same way again
+    const SqlDialect *dialect = m_dbHandler->dialect();
+    auto classify = [dialect](const QSqlError &error) {
+        if (dialect->isConnectionLost(error)) return ConnectionLost;
+        return dialect->isTransient(error) ? Retry : Failed;
+    };
+    auto fail = [&db, &classify](const QSqlQuery &query, const char *what) {
+        qDebug() << what << query.lastError().text();
+        db.rollback();
+        return classify(query.lastError());
+    };
+
+    if (!db.transaction()) {
+        qDebug() << "Failed to start sale transaction:" << db.lastError().text();
+        return classify(db.lastError());
+    }
+    QSqlQuery query(db);
+
+    if (!journalId.isEmpty()) {
+        // Replays are idempotent: a sale whose marker exists was applied before a crash or timeout
+        query.prepare("INSERT INTO SaleJournalApplied (journal_id, applied_at) VALUES (?, " + dialect->now() + ")");
+        query.addBindValue(journalId);
+        if (!query.exec()) {
+            if (dialect->isDuplicateKey(query.lastError())) {
+                db.rollback();
+                return AlreadyApplied;
+            }
+            return fail(query, "Failed to record journal replay:");
         }
     }
 
-    db.commit();
-    emit salesUpdated();
-    return true;
+    // The guard makes check and decrement one atomic step: a product another terminal has
+    // already sold down simply isn't updated, so a short affected-row count means oversell.
+    // A forced replay records a sale that already happened offline, clamping stock at zero.
+    query.prepare(forceStock
+                      ? dialect->updateJoin("Products", "p", soldTable, "p.product_id = s.product_id",
+                                            "quantity = " + dialect->greatest("p.quantity - s.qty", "0"))
+                      : dialect->updateJoin("Products", "p", soldTable, "p.product_id = s.product_id",
+                                            "quantity = p.quantity - s.qty", "p.quantity >= s.qty"));
+    bindUnits(query);
+    if (!query.exec()) return fail(query, "Failed to update inventory:");
+    if (!forceStock && query.numRowsAffected() != unitsByProduct.size()) {
+        db.rollback();
+        if (shortages) *shortages = findShortages(db, items, unitsByProduct);
+        return Shortage;
+    }
+
+    // A journaled sale keeps the time it was rung up, not the time it was replayed. Bound as
+    // text in the layout both backends store, so the history and rollup day agree with it.
+    const bool backdated = soldAt.isValid();
+    const QString soldAtText = soldAt.toString("yyyy-MM-dd hh:mm:ss");
+
+    // The header carries the totals, so receipts and transaction stats never regroup lines
+    CachedQuery cachedOrder = m_dbHandler->statementCache()->acquire(db, backdated
+        ? "INSERT INTO Orders (salesman_id, total_amount, item_count, unit_count, order_date) VALUES (?, ?, ?, ?, ?)"
+        : "INSERT INTO Orders (salesman_id, total_amount, item_count, unit_count) VALUES (?, ?, ?, ?)");
+    if (!cachedOrder) {
+        db.rollback();
+        return Failed;
+    }
+    cachedOrder->addBindValue(userId);
+    cachedOrder->addBindValue(revenue);
+    cachedOrder->addBindValue(items.size());
+    cachedOrder->addBindValue(units);
+    if (backdated) cachedOrder->addBindValue(soldAtText);
+    if (!cachedOrder->exec()) return fail(*cachedOrder, "Failed to create order:");
+    orderId = cachedOrder->lastInsertId().toInt();
+
+    QStringList rows;
+    for (int i = 0; i < items.size(); ++i) rows.append("(" + placeholderRow(backdated ? 9 : 8) + ")");
+    query.prepare("INSERT INTO Sales (order_id, salesman_id, product_id, product_name, price, category, "
+                  "quantity_sold, total_price" + QString(backdated ? ", sale_date" : "") + ") VALUES "
+                  + rows.join(", "));
+    for (const auto &item : items) {
+        query.addBindValue(orderId);
+        query.addBindValue(userId);
+        query.addBindValue(item.productId);
+        query.addBindValue(item.productName);
+        query.addBindValue(item.unitPrice);
+        query.addBindValue(item.category);
+        query.addBindValue(item.quantity);
+        query.addBindValue(item.totalPrice);
+        if (backdated) query.addBindValue(soldAtText);
+    }
+    if (!query.exec()) return fail(query, "Failed to process sale:");
+
+    // Clamped like Products on a forced replay, so the summary still matches it
+    const QString stockLeft = forceStock ? dialect->greatest("ps.quantity - s.qty", "0") : "ps.quantity - s.qty";
+    query.prepare(dialect->updateJoin("ProductStock", "ps", soldTable, "ps.product_id = s.product_id",
+                                      "quantity = " + stockLeft + ", sold_quantity = ps.sold_quantity + s.qty"));
+    bindUnits(query);
+    if (!query.exec()) return fail(query, "Failed to update stock summary:");
+
+    // One checkout is one transaction in the rollup row of the day it was sold
+    CachedQuery cachedRollup = m_dbHandler->statementCache()->acquire(db, dialect->upsert(
+        "INSERT INTO SalesDaily (sale_day, revenue, units, transactions) VALUES ("
+            + (backdated ? QString("?") : dialect->today()) + ", ?, ?, 1)",
+        "sale_day",
+        {"revenue = revenue + " + dialect->excluded("revenue"), "units = units + " + dialect->excluded("units"),
+         "transactions = transactions + 1"}));
+    if (!cachedRollup) {
+        db.rollback();
+        return Failed;
+    }
+    if (backdated) cachedRollup->addBindValue(soldAt.date().toString(Qt::ISODate));
+    cachedRollup->addBindValue(revenue);
+    cachedRollup->addBindValue(units);
+    if (!cachedRollup->exec()) return fail(*cachedRollup, "Failed to update daily sales rollup:");
+
+    if (!db.commit()) {
+        // The outcome of a lost COMMIT is unknown. A live sale is reported as a failure, never
+        // journaled; a replay is simply tried again, and its marker says whether it landed.
+        qDebug() << "Failed to commit sale:" << db.lastError().text();
+        db.rollback();
+        return journalId.isEmpty() ? Failed : Retry;
+    }
+    return Committed;
+}
+
+QList<StockShortage> SalesManager::findShortages(QSqlDatabase db, const QList<SaleItem> &items,
+                                                const QMap<int, int> &unitsByProduct)
+{
+    // Only runs after a failed sale has rolled back, so the happy path never pays for it
+    QList<StockShortage> shortages;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT product_id, quantity FROM Products WHERE product_id IN ("
+                  + placeholderRow(unitsByProduct.size()) + ")");
+    for (auto it = unitsByProduct.constBegin(); it != unitsByProduct.constEnd(); ++it) query.addBindValue(it.key());
+    if (!query.exec()) {
+        qDebug() << "Failed to check stock:" << query.lastError().text();
+        return shortages;
+    }
+    QHash<int, int> stock;
+    RowReader rows(query);
+    while (rows.next()) stock.insert(rows.toInt(0), rows.toInt(1));
+
+    QSet<int> reported;
+    for (const auto &item : items) {
+        const int requested = unitsByProduct.value(item.productId);
+        const int available = stock.value(item.productId, 0); // A deleted product has none
+        if (available >= requested || reported.contains(item.productId)) continue;
+        reported.insert(item.productId);
+        shortages.append({item.productId, item.productName, requested, available});
+    }
+    return shortages;
+}
+
+QString SalesManager::describeShortages(const QList<StockShortage> &shortages)
+{
+    QStringList lines;
+    for (const auto &shortage : shortages) {
+        lines.append(QString("'%1': %2 requested, %3 in stock")
+                         .arg(shortage.productName).arg(shortage.requested).arg(shortage.available));
+    }
+    return "Not enough stock for:\n" + lines.join("\n");
 }
 
 bool SalesManager::getSalesStats(int &totalSales, double &totalAmount, double &profitMargin)
 {
     if (!m_dbHandler->isConnected()) return false;
 
-    QSqlQuery query;
-    query.prepare("SELECT COUNT(*) as total_sales, COALESCE(SUM(total_price), 0) as total_amount FROM Sales");
+    // Uses a pooled connection so it can run alongside the other dashboard stats
+    PooledConnection connection(m_dbHandler->pool());
+    if (!connection.isValid()) return false;
 
-    if (!query.exec() || !query.next()) {
+    QSqlQuery query(connection.database());
+    if (!query.exec("SELECT COUNT(*) as total_sales, COALESCE(SUM(total_amount), 0) as total_amount FROM Orders")
+        || !query.next()) {
         qDebug() << "Failed to get sales stats:" << query.lastError().text();
         return false;
     }
@@ -251,39 +553,140 @@ bool SalesManager::getSalesStats(int &totalSales, double &totalAmount, double &p
     return true;
 }
 
-bool SalesManager::executeSalesQuery(QTableWidget *tableWidget, const QString &queryStr)
+bool SalesManager::getReceipt(int orderId, SaleOrder &order, QList<SaleItem> &lines)
 {
-    QSqlQuery query;
-    query.prepare(queryStr);
-    return executeSalesQuery(tableWidget, query);
+    if (!m_dbHandler->isConnected()) return false;
+
+    PooledConnection connection(m_dbHandler->pool());
+    if (!connection.isValid()) return false;
+
+    // Header by primary key, lines through idx_sales_order
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT salesman_id, order_date, total_amount, item_count, unit_count FROM Orders WHERE order_id = ?");
+    query.addBindValue(orderId);
+    RowReader header(query);
+    if (!query.exec() || !header.next()) {
+        qDebug() << "Failed to load order" << orderId << ":" << query.lastError().text();
+        return false;
+    }
+    order.orderId = orderId;
+    order.salesmanId = header.toInt(0);
+    order.orderDate = header.toDateTime(1);
+    order.totalAmount = header.toDouble(2);
+    order.itemCount = header.toInt(3);
+    order.unitCount = header.toInt(4);
+
+    query.prepare("SELECT product_id, product_name, price, category, quantity_sold, total_price "
+                  "FROM Sales WHERE order_id = ? ORDER BY sales_id");
+    query.addBindValue(orderId);
+    if (!query.exec()) {
+        qDebug() << "Failed to load order lines:" << query.lastError().text();
+        return false;
+    }
+    lines.clear();
+    RowReader rows(query);
+    while (rows.next()) {
+        SaleItem item;
+        item.productId = rows.toInt(0);
+        item.productName = rows.toString(1);
+        item.unitPrice = rows.toDouble(2);
+        item.category = rows.toString(3);
+        item.available = 0;
+        item.quantity = rows.toInt(4);
+        item.totalPrice = rows.toDouble(5);
+        lines.append(item);
+    }
+    return true;
 }
 
-bool SalesManager::executeSalesQuery(QTableWidget *tableWidget, QSqlQuery &query)
+bool SalesManager::exportSales(const QString &path, const QDate &from, const QDate &to)
 {
     if (!m_dbHandler->isConnected()) {
-        qDebug() << "Database not connected";
+        qDebug() << "Cannot export sales: database not connected";
         return false;
     }
+    return m_exporter->start(path, from, to);
+}
 
-    tableWidget->setRowCount(0);
+void SalesManager::cancelExport()
+{
+    m_exporter->cancel();
+}
+
+bool SalesManager::getDailySales(QVector<QPair<QDate, double>> &dailySales, int days)
+{
+    // Live sales key the rollup by the server's date, so the window ends on the server's today;
+    // the client's clock or time zone may be a day either side of it. The server works out the
+    // range itself, so the chart costs one checkout and one round trip.
+    const SqlDialect *dialect = m_dbHandler->dialect();
+    return fetchDailySales(dailySales, dialect->daysAgo(qMax(1, days) - 1) + " AND " + dialect->today(), {});
+}
+
+bool SalesManager::getDailySales(QVector<QPair<QDate, double>> &dailySales, const QDate &from, const QDate &to)
+{
+    return fetchDailySales(dailySales, "? AND ?", {from, to});
+}
+
+bool SalesManager::fetchDailySales(QVector<QPair<QDate, double>> &dailySales, const QString &range,
+                                   const QVariantList &params)
+{
+    if (!m_dbHandler->isConnected()) return false;
+
+    PooledConnection connection(m_dbHandler->pool());
+    if (!connection.isValid()) return false;
+
+    // Primary-key range over the rollup: one row per day shown
+    QSqlQuery query(connection.database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT sale_day, revenue FROM SalesDaily WHERE sale_day BETWEEN " + range + " ORDER BY sale_day ASC");
+    for (const QVariant &param : params) query.addBindValue(param);
 
     if (!query.exec()) {
-        qDebug() << "Failed to execute sales query:" << query.lastError().text();
+        qDebug() << "Failed to fetch sales data for chart:" << query.lastError().text();
         return false;
     }
 
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
+    dailySales.clear();
+    RowReader rows(query);
+    while (rows.next()) {
+        dailySales.append({rows.toDate(0), rows.toDouble(1)});
+    }
+    return true;
+}
 
-        for (int col = 0; col < 8; col++) {
-            QString value = (col == 7) ?
-                                query.value("sale_date").toDateTime().toString("yyyy-MM-dd hh:mm:ss") :
-                                query.value(col).toString();
-            tableWidget->setItem(row, col, new QTableWidgetItem(value));
-        }
-        row++;
+bool SalesManager::ensureSalesRollup()
+{
+    if (!m_dbHandler->isConnected()) return false;
+
+    // The schema migrations create the table; it is seeded once from Sales, then processSale keeps it current
+    QSqlQuery query;
+    if (!query.exec("SELECT EXISTS(SELECT 1 FROM SalesDaily), EXISTS(SELECT 1 FROM Orders)") || !query.next()) {
+        qDebug() << "Failed to inspect daily sales rollup:" << query.lastError().text();
+        return false;
     }
+    if (!query.value(0).toBool() && query.value(1).toBool()) return rebuildSalesRollup();
+    return true;
+}
+
+bool SalesManager::rebuildSalesRollup()
+{
+    if (!m_dbHandler->isConnected()) return false;
 
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    // One order is one transaction, and its header already carries the totals
+    QSqlQuery query;
+    if (!query.exec("DELETE FROM SalesDaily")
+        || !query.exec("INSERT INTO SalesDaily (sale_day, revenue, units, transactions) "
+                       "SELECT DATE(order_date), SUM(total_amount), SUM(unit_count), COUNT(*) "
+                       "FROM Orders GROUP BY DATE(order_date)")) {
+        qDebug() << "Failed to rebuild daily sales rollup:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    db.commit();
     return true;
 }
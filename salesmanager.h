@@ -2,11 +2,23 @@
 #define SALESMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
-#include <QVBoxLayout>
 #include <QSqlQuery>
 #include <QList>
+#include <QVector>
+#include <QPair>
+#include <QMap>
+#include <QDate>
+#include <QDateTime>
 #include "saleitem.h"
+#include "rowbuffermodel.h"
+#include "saleshistorymodel.h"
+#include "productindex.h"
+#include "latencyhistogram.h"
+#include "salejournal.h"
+#include "salesexporter.h"
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QSqlDatabase>
 // Forward declarations
 class DatabaseHandler;
 
@@ -18,28 +30,98 @@ class SalesManager : public QObject
 
 public:
     explicit SalesManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
+    ~SalesManager();
+
+    // Paged sales history bound to this manager's database, and a model matching the product-picker SELECT
+    SalesHistoryModel *createSalesModel(const QStringList &headers, QObject *parent = nullptr) const;
+    static RowBufferModel *createProductModel(const QStringList &headers, QObject *parent = nullptr);
 
     // Sales operations
-    bool loadSales(QTableWidget *tableWidget);
-    void searchSales(QTableWidget *tableWidget, const QString &searchText);
-    bool processSale(const QList<SaleItem> &items, int userId);
-    bool getSalesStats(int &totalSales, double &totalAmount, double &profitMargin);
+    bool loadSales(SalesHistoryModel *model);
+    quint64 searchSales(SalesHistoryModel *model, const QString &searchText); // Worker request id
+    bool loadNewSales(SalesHistoryModel *model);
+    // Fails without writing anything if any product lacks stock; shortages then lists those lines.
+    // If the database is unreachable or slow the sale is journaled locally instead and replayed
+    // in the background; that still counts as success, with orderId 0 until it is replayed.
+    bool processSale(const QList<SaleItem> &items, int userId, QList<StockShortage> *shortages = nullptr,
+                     int *orderId = nullptr);
+    static QString describeShortages(const QList<StockShortage> &shortages);
+    bool getSalesStats(int &totalSales, double &totalAmount, double &profitMargin); // totalSales counts orders
+
+    // Read from the Orders header; lines are only touched for a receipt
+    bool getReceipt(int orderId, SaleOrder &order, QList<SaleItem> &lines);
+    bool getDailySales(QVector<QPair<QDate, double>> &dailySales, const QDate &from, const QDate &to);
+    bool getDailySales(QVector<QPair<QDate, double>> &dailySales, int days); // The newest `days` days by the server date
+
+    // CSV export of the lines dated from..to, in the background; see SalesExporter
+    bool exportSales(const QString &path, const QDate &from, const QDate &to); // False if one is running
+    void cancelExport();
+
+    // SalesDaily rollup (one row per day: revenue, units, transactions), updated by processSale
+    bool ensureSalesRollup();
+    bool rebuildSalesRollup();
 
     // Product operations
-    bool searchProducts(QTableWidget *tableWidget, const QString &searchText);
+    bool searchProducts(RowBufferModel *model, const QString &searchText);
     bool getProductInfo(int productId, SaleItem &item);
-    bool getProductsForRecommendation(QVBoxLayout *layout, const QString &searchText);
+    // Up to 10 in-stock products for the search text; products is cleared first
+    bool getProductsForRecommendation(QVector<IndexedProduct> &products, const QString &searchText);
+
+    // Scanner fast path: resolves a SKU / barcode from the in-memory product index into a
+    // one-unit cart line. No database round trip; stock is re-checked by processSale.
+    bool lookupCode(const QString &code, SaleItem &item) const;
+    LatencyHistogram &scanLatency() { return m_scanLatency; } // Scan to cart, recorded by the views
+
+    int journalPending() const { return m_journal.pendingCount(); }
+    bool isOffline() const { return m_offline; }
+
+public slots:
+    void replayJournal();
 
 signals:
     void salesUpdated();
-    void productSelectedFromWidget(int productId, QString productName, double price, QString category, int available);
+    void journalChanged(int pending);
+    void journalConflicts(const QStringList &messages); // Replayed sales that needed attention
+    void exportProgress(qint64 rowsWritten, qint64 totalRows);
+    void exportFinished(const ExportReport &report);
+
+private slots:
+    void onReplayFinished();
 
 private:
-    void createProductWidget(QVBoxLayout *layout, const QSqlQuery &query);
-    bool executeSalesQuery(QTableWidget *tableWidget, const QString &queryStr);
-    bool executeSalesQuery(QTableWidget *tableWidget, QSqlQuery &query);
+    // Retry: nothing was written, or a replay marker makes writing it again safe; try later
+    enum WriteOutcome { Committed, Shortage, AlreadyApplied, ConnectionLost, Retry, Failed };
+
+    struct ReplayResult {
+        bool reachable = false;
+        bool deferred = false; // A sale hit a transient error; the batch resumes from it on the next tick
+        int applied = 0;
+        double revenue = 0.0;
+        int units = 0;
+        QStringList conflicts;
+    };
+
+    // One sale in one transaction on db. A non-empty journalId makes it idempotent; a valid soldAt
+    // dates it instead of the server clock; forceStock skips the stock guard for sales that
+    // already happened offline.
+    WriteOutcome writeSale(QSqlDatabase db, const QList<SaleItem> &items, int userId, const QString &journalId,
+                           const QDateTime &soldAt, bool forceStock, QList<StockShortage> *shortages,
+                           double &revenue, int &units, int &orderId);
+    bool fetchDailySales(QVector<QPair<QDate, double>> &dailySales, const QString &range, const QVariantList &params);
+    QList<StockShortage> findShortages(QSqlDatabase db, const QList<SaleItem> &items,
+                                       const QMap<int, int> &unitsByProduct);
+    bool journalSale(const QList<SaleItem> &items, int userId);
+    ReplayResult replayBatch();
+    void onJournalDrained();
 
     DatabaseHandler *m_dbHandler;
+    LatencyHistogram m_scanLatency;
+    SaleJournal m_journal;
+    bool m_offline;            // Sales go to the journal until it drains
+    bool m_mainConnectionLost; // The default connection needs reopening once the server is back
+    QTimer m_replayTimer;
+    QFutureWatcher<ReplayResult> m_replayWatcher;
+    SalesExporter *m_exporter;
 };
 
 #endif // SALESMANAGER_H
@@ -0,0 +1,251 @@
+#include "schemamigrator.h"
+#include "sqldialect.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+namespace {
+// Index = version - 1. Append only: a shipped migration never changes.
+const char *const kMigrations[] = {
+    "Core tables",
+    "Products.sku with a unique key",
+    "ProductStock summary",
+    "SalesDaily rollup",
+    "SaleJournalApplied replay markers",
+    "Indexes for the sales history, stock and product queries",
+    "Orders header table; Sales lines reference their order",
+};
+}
+
+const SchemaMigrator::QueryIndex SchemaMigrator::kQueryIndexes[] = {
+    // Stock summary rebuild/verify and per-product sales
+    {6, "Sales", "idx_sales_product", "product_id",
+     "SELECT SUM(quantity_sold) FROM Sales WHERE product_id = 1"},
+    // Sales history keyset paging: newest first, cursor on (sale_date, sales_id)
+    {6, "Sales", "idx_sales_date_id", "sale_date, sales_id",
+     "SELECT sales_id FROM Sales WHERE sale_date < '2000-01-01' ORDER BY sale_date DESC, sales_id DESC LIMIT 50"},
+    // One salesman's sales over a period
+    {6, "Sales", "idx_sales_salesman_date", "salesman_id, sale_date",
+     "SELECT sales_id FROM Sales WHERE salesman_id = 1 AND sale_date >= '2000-01-01'"},
+    // Product lists and the recommendation fallback are ordered by name
+    {6, "Products", "idx_products_name", "product_name",
+     "SELECT product_id FROM Products ORDER BY product_name LIMIT 10"},
+    // Orders over a date range, and the daily rollup rebuild
+    {7, "Orders", "idx_orders_date", "order_date",
+     "SELECT order_id FROM Orders WHERE order_date >= '2000-01-01' AND order_date < '2000-02-01'"},
+    // One salesman's transactions; also matches lines to orders during the backfill
+    {7, "Orders", "idx_orders_salesman_date", "salesman_id, order_date",
+     "SELECT order_id FROM Orders WHERE salesman_id = 1 AND order_date >= '2000-01-01'"},
+    // Receipt lookup: the lines of one order
+    {7, "Sales", "idx_sales_order", "order_id",
+     "SELECT sales_id FROM Sales WHERE order_id = 1"},
+};
+
+SchemaMigrator::SchemaMigrator(QSqlDatabase db, const SqlDialect *dialect)
+    : m_db(db), m_dialect(dialect), m_version(0)
+{
+}
+
+int SchemaMigrator::latestVersion()
+{
+    return int(sizeof(kMigrations) / sizeof(kMigrations[0]));
+}
+
+bool SchemaMigrator::exec(const QString &sql)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(sql)) {
+        qDebug() << "Migration statement failed:" << query.lastError().text() << "\n" << sql;
+        return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::migrate()
+{
+    if (!exec("CREATE TABLE IF NOT EXISTS SchemaVersion ("
+              "version INT NOT NULL PRIMARY KEY, "
+              "description VARCHAR(255) NOT NULL, "
+              "applied_at DATETIME NOT NULL)")) {
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    if (!query.exec("SELECT COALESCE(MAX(version), 0) FROM SchemaVersion") || !query.next()) {
+        qDebug() << "Failed to read schema version:" << query.lastError().text();
+        return false;
+    }
+    m_version = query.value(0).toInt();
+    if (m_version > latestVersion()) {
+        // A newer build migrated this database; its extra tables and indexes don't hurt this one
+        qDebug() << "Schema version" << m_version << "is newer than this build's" << latestVersion();
+        return true;
+    }
+
+    while (m_version < latestVersion()) {
+        const int version = m_version + 1;
+        m_db.transaction(); // Atomic on SQLite; MySQL commits each DDL statement regardless
+        if (!applyMigration(version)) {
+            m_db.rollback();
+            qDebug() << "Migration" << version << "failed:" << kMigrations[version - 1];
+            return false;
+        }
+
+        query.prepare("INSERT INTO SchemaVersion (version, description, applied_at) VALUES (?, ?, "
+                      + m_dialect->now() + ")");
+        query.addBindValue(version);
+        query.addBindValue(QString(kMigrations[version - 1]));
+        if (!query.exec() && !m_dialect->isDuplicateKey(query.lastError())) { // Another till got there first
+            qDebug() << "Failed to record migration" << version << ":" << query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+        m_db.commit();
+        qDebug() << "Applied migration" << version << ":" << kMigrations[version - 1];
+        m_version = version;
+    }
+    return true;
+}
+
+bool SchemaMigrator::applyMigration(int version)
+{
+    switch (version) {
+    case 1: return createCoreTables();
+    case 2: return addProductSku();
+    case 3: return createStockSummary();
+    case 4: return createSalesRollup();
+    case 5: return createJournalMarkers();
+    case 6: return createQueryIndexes(6);
+    case 7: return createOrders();
+    default: return false;
+    }
+}
+
+bool SchemaMigrator::createCoreTables()
+{
+    // A server database usually has these already; IF NOT EXISTS leaves them alone
+    for (const QString &statement : m_dialect->baseSchema()) {
+        if (!exec(statement)) return false;
+    }
+    if (!m_dialect->isEmbedded()) return true;
+
+    // A fresh embedded file needs someone who can log in
+    QSqlQuery query(m_db);
+    if (!query.exec("SELECT COUNT(*) FROM Users") || !query.next()) return false;
+    if (query.value(0).toInt() > 0) return true;
+    if (!exec("INSERT INTO Users (username, password, role) VALUES ('admin', 'admin', 'Admin')")) return false;
+    qDebug() << "Created database" << m_db.databaseName() << "- log in as admin/admin and change the password";
+    return true;
+}
+
+bool SchemaMigrator::addProductSku()
+{
+    if (m_dialect->hasColumn(m_db, "Products", "sku")) return true;
+
+    // Two portable statements; SQLite's ALTER TABLE can't add a key
+    return exec("ALTER TABLE Products ADD COLUMN sku VARCHAR(64) NULL")
+           && exec("CREATE UNIQUE INDEX uq_products_sku ON Products (sku)");
+}
+
+bool SchemaMigrator::createStockSummary()
+{
+    return exec("CREATE TABLE IF NOT EXISTS ProductStock ("
+                "product_id INT NOT NULL PRIMARY KEY, "
+                "product_name VARCHAR(255) NOT NULL, "
+                "price DECIMAL(10,2) NOT NULL, "
+                "category VARCHAR(255), "
+                "quantity INT NOT NULL DEFAULT 0, "
+                "sold_quantity INT NOT NULL DEFAULT 0)");
+}
+
+bool SchemaMigrator::createSalesRollup()
+{
+    return exec("CREATE TABLE IF NOT EXISTS SalesDaily ("
+                "sale_day DATE NOT NULL PRIMARY KEY, "
+                "revenue DECIMAL(14,2) NOT NULL DEFAULT 0, "
+                "units INT NOT NULL DEFAULT 0, "
+                "transactions INT NOT NULL DEFAULT 0)");
+}
+
+bool SchemaMigrator::createJournalMarkers()
+{
+    return exec("CREATE TABLE IF NOT EXISTS SaleJournalApplied ("
+                "journal_id CHAR(36) NOT NULL PRIMARY KEY, "
+                "applied_at DATETIME NOT NULL)");
+}
+
+bool SchemaMigrator::createIndex(const QueryIndex &index)
+{
+    if (m_dialect->hasIndex(m_db, index.table, index.name)) return true;
+
+    // MySQL has no CREATE INDEX IF NOT EXISTS; if this loses a race the index is there anyway
+    const bool created = exec(QString("CREATE INDEX %1 ON %2 (%3)").arg(index.name, index.table, index.columns));
+    return created || m_dialect->hasIndex(m_db, index.table, index.name);
+}
+
+bool SchemaMigrator::createQueryIndexes(int version)
+{
+    for (const QueryIndex &index : kQueryIndexes) {
+        if (index.version == version && !createIndex(index)) return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::createOrders()
+{
+    if (!exec("CREATE TABLE IF NOT EXISTS Orders ("
+              "order_id " + m_dialect->autoIncrementKey() + ", "
+              "salesman_id INT NOT NULL, "
+              "order_date DATETIME NOT NULL " + m_dialect->timestampDefault() + ", "
+              "total_amount DECIMAL(12,2) NOT NULL DEFAULT 0, "
+              "item_count INT NOT NULL DEFAULT 0, "
+              "unit_count INT NOT NULL DEFAULT 0)")) {
+        return false;
+    }
+    if (!m_dialect->hasColumn(m_db, "Sales", "order_id") && !exec("ALTER TABLE Sales ADD COLUMN order_id INT NULL")) {
+        return false;
+    }
+    if (!createQueryIndexes(7)) return false;
+
+    // Older lines have no order. Those written by one checkout share a salesman and timestamp,
+    // the same approximation the daily rollup used, so group them into one order each.
+    QSqlQuery query(m_db);
+    if (!query.exec("SELECT EXISTS(SELECT 1 FROM Orders), EXISTS(SELECT 1 FROM Sales WHERE order_id IS NULL)")
+        || !query.next()) {
+        qDebug() << "Failed to inspect orders:" << query.lastError().text();
+        return false;
+    }
+    if (!query.value(1).toBool()) return true;
+    if (!query.value(0).toBool()
+        && !exec("INSERT INTO Orders (salesman_id, order_date, total_amount, item_count, unit_count) "
+                 "SELECT salesman_id, sale_date, SUM(total_price), COUNT(*), SUM(quantity_sold) "
+                 "FROM Sales GROUP BY salesman_id, sale_date")) {
+        return false;
+    }
+    return exec("UPDATE Sales SET order_id = (SELECT o.order_id FROM Orders o "
+                "WHERE o.salesman_id = Sales.salesman_id AND o.order_date = Sales.sale_date) "
+                "WHERE order_id IS NULL");
+}
+
+int SchemaMigrator::verifyIndexes()
+{
+    int unused = 0;
+    for (const QueryIndex &index : kQueryIndexes) {
+        if (!m_dialect->hasIndex(m_db, index.table, index.name)) {
+            qDebug() << "Index" << index.name << "is missing; recreating it";
+            if (!createIndex(index)) {
+                ++unused;
+                continue;
+            }
+        }
+
+        const QStringList planned = m_dialect->plannedIndexes(m_db, index.probe);
+        if (!planned.contains(index.name)) {
+            // A near-empty table may legitimately be scanned; a large one means a slow screen
+            qDebug() << "Query plan does not use" << index.name << "- planner chose" << planned
+                     << "for:" << index.probe;
+            ++unused;
+        }
+    }
+    return unused;
+}
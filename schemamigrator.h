@@ -0,0 +1,54 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+class SqlDialect;
+
+// Brings a database up to the schema this build expects. Migrations are numbered and recorded in
+// SchemaVersion once applied, so a startup only runs the steps the database hasn't seen yet.
+// Every step is also idempotent (IF NOT EXISTS, catalog checks): MySQL commits DDL implicitly, so
+// a step interrupted halfway, or raced by a second till starting up, must be safe to run again.
+class SchemaMigrator
+{
+public:
+    SchemaMigrator(QSqlDatabase db, const SqlDialect *dialect);
+
+    bool migrate();
+    int currentVersion() const { return m_version; }
+    static int latestVersion();
+
+    // Recreates any query index that went missing, then EXPLAINs the hot queries and logs those
+    // whose plan doesn't use their index. Returns how many didn't.
+    int verifyIndexes();
+
+private:
+    struct QueryIndex {
+        int version; // Migration that introduced it
+        const char *table;
+        const char *name;
+        const char *columns;
+        const char *probe; // Representative SELECT that should be served by the index
+    };
+    static const QueryIndex kQueryIndexes[];
+
+    bool applyMigration(int version);
+    bool exec(const QString &sql);
+    bool createIndex(const QueryIndex &index);
+
+    bool createCoreTables();
+    bool addProductSku();
+    bool createStockSummary();
+    bool createSalesRollup();
+    bool createJournalMarkers();
+    bool createQueryIndexes(int version);
+    bool createOrders();
+
+    QSqlDatabase m_db;
+    const SqlDialect *m_dialect;
+    int m_version;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,63 @@
+#include "searchcontroller.h"
+#include "databasehandler.h"
+
+SearchController::SearchController(DatabaseHandler *dbHandler, int debounceMs, QObject *parent)
+    : QObject(parent)
+    , m_dbHandler(dbHandler)
+    , m_debounceMs(debounceMs)
+    , m_keystrokes(0)
+    , m_queriesIssued(0)
+    , m_queriesCancelled(0)
+    , m_staleResults(0)
+{
+    connect(m_dbHandler->worker(), &DatabaseWorker::queryFinished, this, &SearchController::onQueryFinished);
+}
+
+void SearchController::attach(QLineEdit *edit, SearchFunction search)
+{
+    if (!edit) return;
+
+    m_channels.push_back(std::make_unique<Channel>());
+    Channel *channel = m_channels.back().get();
+    channel->edit = edit;
+    channel->search = std::move(search);
+    channel->timer.setSingleShot(true);
+    channel->timer.setInterval(m_debounceMs);
+
+    connect(&channel->timer, &QTimer::timeout, this, [this, channel]() { fire(channel); });
+    connect(edit, &QLineEdit::textChanged, this, [this, channel]() { onTextChanged(channel); });
+}
+
+void SearchController::onTextChanged(Channel *channel)
+{
+    ++m_keystrokes;
+    ++channel->generation;
+
+    // Whatever is running was for older text; stop it now rather than after the debounce
+    if (channel->inflight != 0) {
+        m_dbHandler->cancelQuery(channel->inflight);
+        channel->inflight = 0;
+        ++m_queriesCancelled;
+    }
+    channel->timer.start();
+}
+
+void SearchController::fire(Channel *channel)
+{
+    if (!channel->edit || !channel->search) return;
+
+    channel->issuedGeneration = channel->generation;
+    channel->inflight = channel->search(channel->edit->text());
+    ++m_queriesIssued;
+}
+
+void SearchController::onQueryFinished(quint64 requestId, const DbResult &result)
+{
+    for (const auto &channel : m_channels) {
+        if (channel->inflight != requestId) continue;
+        channel->inflight = 0;
+        // Input moved on while the query ran; the loader drops it in favour of the next request
+        if (channel->issuedGeneration != channel->generation && !result.cancelled) ++m_staleResults;
+        return;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SEARCHCONTROLLER_H
+#define SEARCHCONTROLLER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QPointer>
+#include <QLineEdit>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "databaseworker.h"
+
+class DatabaseHandler;
+
+// Shared search-as-you-type front end. Each attached line edit gets its own debounce timer and
+// generation counter: a keystroke bumps the generation, cancels the query still running for an
+// older generation (KILL QUERY if it already reached the server) and restarts the timer, so only
+// the text the user pauses on is queried. Results for superseded requests are dropped by the
+// model loaders, which only apply a model's newest request.
+class SearchController : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Runs the search for text and returns its worker request id, or 0 if it ran synchronously
+    using SearchFunction = std::function<quint64(const QString &text)>;
+
+    explicit SearchController(DatabaseHandler *dbHandler, int debounceMs = 250, QObject *parent = nullptr);
+
+    void attach(QLineEdit *edit, SearchFunction search);
+
+    quint64 keystrokes() const { return m_keystrokes; }
+    quint64 queriesIssued() const { return m_queriesIssued; }
+    quint64 queriesCancelled() const { return m_queriesCancelled; }
+    quint64 staleResults() const { return m_staleResults; }
+
+private slots:
+    void onQueryFinished(quint64 requestId, const DbResult &result);
+
+private:
+    struct Channel {
+        QPointer<QLineEdit> edit;
+        QTimer timer;
+        SearchFunction search;
+        quint64 generation = 0;       // Bumped on every edit
+        quint64 issuedGeneration = 0; // Generation of the last query issued
+        quint64 inflight = 0;         // Worker request still running, 0 if none
+    };
+
+    void onTextChanged(Channel *channel);
+    void fire(Channel *channel);
+
+    DatabaseHandler *m_dbHandler;
+    int m_debounceMs;
+    std::vector<std::unique_ptr<Channel>> m_channels;
+    quint64 m_keystrokes;
+    quint64 m_queriesIssued;
+    quint64 m_queriesCancelled;
+    quint64 m_staleResults;
+};
+
+#endif // SEARCHCONTROLLER_H
@@ -0,0 +1,316 @@
+#include "sqldialect.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QRegularExpression>
+#include <QDebug>
+
+namespace {
+class MySqlDialect : public SqlDialect
+{
+public:
+    QString name() const override { return "mysql"; }
+    QString driverName() const override { return "QMYSQL"; }
+    bool isEmbedded() const override { return false; }
+
+    QString now() const override { return "NOW()"; }
+    QString today() const override { return "CURDATE()"; }
+    QString daysAgo(int days) const override { return QString("DATE_SUB(CURDATE(), INTERVAL %1 DAY)").arg(days); }
+    QString concat(const QStringList &expressions) const override { return "CONCAT(" + expressions.join(", ") + ")"; }
+    QString greatest(const QString &a, const QString &b) const override { return "GREATEST(" + a + ", " + b + ")"; }
+    QString nullSafeEquals(const QString &a, const QString &b) const override { return a + " <=> " + b; }
+    QString forUpdate() const override { return " FOR UPDATE"; }
+
+    QString updateJoin(const QString &table, const QString &alias, const QString &source, const QString &on,
+                       const QString &assignments, const QString &where) const override
+    {
+        return "UPDATE " + table + " " + alias + " JOIN " + source + " ON " + on + " SET " + assignments
+               + (where.isEmpty() ? QString() : " WHERE " + where);
+    }
+    QString upsert(const QString &insert, const QString &, const QStringList &assignments) const override
+    {
+        return insert + " ON DUPLICATE KEY UPDATE " + assignments.join(", ");
+    }
+    QString excluded(const QString &column) const override { return "VALUES(" + column + ")"; }
+    int maxBindValues() const override { return 65535; }
+
+    QString autoIncrementKey() const override { return "INT NOT NULL AUTO_INCREMENT PRIMARY KEY"; }
+    QString timestampDefault() const override { return "DEFAULT CURRENT_TIMESTAMP"; }
+
+    bool isDuplicateKey(const QSqlError &error) const override
+    {
+        return error.nativeErrorCode() == "1062"; // ER_DUP_ENTRY
+    }
+    bool isConnectionLost(const QSqlError &error) const override
+    {
+        // CR_CONNECTION_ERROR, CR_CONN_HOST_ERROR, CR_SERVER_GONE_ERROR, CR_SERVER_LOST
+        static const QStringList lostCodes{"2002", "2003", "2006", "2013"};
+        return error.type() == QSqlError::ConnectionError || lostCodes.contains(error.nativeErrorCode());
+    }
+    bool isTransient(const QSqlError &error) const override
+    {
+        // ER_LOCK_WAIT_TIMEOUT, ER_LOCK_DEADLOCK
+        const QString code = error.nativeErrorCode();
+        return code == "1205" || code == "1213";
+    }
+    bool isInterrupted(const QSqlError &error) const override
+    {
+        return error.nativeErrorCode() == "1317"; // ER_QUERY_INTERRUPTED
+    }
+
+    bool hasColumn(QSqlDatabase db, const QString &table, const QString &column) const override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT COUNT(*) FROM information_schema.COLUMNS "
+                      "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ? AND COLUMN_NAME = ?");
+        query.addBindValue(table);
+        query.addBindValue(column);
+        if (!query.exec() || !query.next()) {
+            qDebug() << "Failed to inspect" << table << "columns:" << query.lastError().text();
+            return false;
+        }
+        return query.value(0).toInt() > 0;
+    }
+    bool hasIndex(QSqlDatabase db, const QString &table, const QString &index) const override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT COUNT(*) FROM information_schema.STATISTICS "
+                      "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ? AND INDEX_NAME = ?");
+        query.addBindValue(table);
+        query.addBindValue(index);
+        if (!query.exec() || !query.next()) {
+            qDebug() << "Failed to inspect" << table << "indexes:" << query.lastError().text();
+            return false;
+        }
+        return query.value(0).toInt() > 0;
+    }
+    QStringList plannedIndexes(QSqlDatabase db, const QString &select) const override
+    {
+        QStringList indexes;
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec("EXPLAIN " + select)) {
+            qDebug() << "EXPLAIN failed:" << query.lastError().text();
+            return indexes;
+        }
+        const int keyColumn = query.record().indexOf("key");
+        while (query.next()) {
+            if (!query.isNull(keyColumn)) indexes.append(query.value(keyColumn).toString());
+        }
+        return indexes;
+    }
+
+    bool prepareConnection(QSqlDatabase) const override { return true; }
+    QString connectOptions(int timeoutSecs) const override
+    {
+        // libmysqlclient retries a timed-out read, so a dead server costs a small multiple of this
+        return QString("MYSQL_OPT_CONNECT_TIMEOUT=%1;MYSQL_OPT_READ_TIMEOUT=%1;MYSQL_OPT_WRITE_TIMEOUT=%1")
+            .arg(timeoutSecs);
+    }
+    QString connectionIdQuery() const override { return "SELECT CONNECTION_ID()"; }
+    QString cancelStatement(qint64 connectionId) const override
+    {
+        return QString("KILL QUERY %1").arg(connectionId);
+    }
+};
+
+class SqliteDialect : public SqlDialect
+{
+public:
+    QString name() const override { return "sqlite"; }
+    QString driverName() const override { return "QSQLITE"; }
+    bool isEmbedded() const override { return true; }
+
+    // Stored as text in the same layout MySQL returns, so the models parse both alike
+    QString now() const override { return "datetime('now', 'localtime')"; }
+    QString today() const override { return "date('now', 'localtime')"; }
+    QString daysAgo(int days) const override { return QString("date('now', 'localtime', '-%1 days')").arg(days); }
+    QString concat(const QStringList &expressions) const override { return "(" + expressions.join(" || ") + ")"; }
+    QString greatest(const QString &a, const QString &b) const override { return "MAX(" + a + ", " + b + ")"; }
+    QString nullSafeEquals(const QString &a, const QString &b) const override { return a + " IS " + b; }
+    QString forUpdate() const override { return QString(); } // The write lock covers the whole file
+
+    QString updateJoin(const QString &table, const QString &alias, const QString &source, const QString &on,
+                       const QString &assignments, const QString &where) const override
+    {
+        // UPDATE ... FROM, SQLite 3.33+
+        return "UPDATE " + table + " AS " + alias + " SET " + assignments + " FROM " + source
+               + " WHERE " + on + (where.isEmpty() ? QString() : " AND " + where);
+    }
+    QString upsert(const QString &insert, const QString &key, const QStringList &assignments) const override
+    {
+        return insert + " ON CONFLICT(" + key + ") DO UPDATE SET " + assignments.join(", ");
+    }
+    QString excluded(const QString &column) const override { return "excluded." + column; }
+    int maxBindValues() const override { return 999; } // SQLITE_MAX_VARIABLE_NUMBER before 3.32
+
+    QString autoIncrementKey() const override { return "INTEGER PRIMARY KEY AUTOINCREMENT"; }
+    QString timestampDefault() const override { return "DEFAULT (datetime('now', 'localtime'))"; }
+
+    bool isDuplicateKey(const QSqlError &error) const override
+    {
+        // SQLITE_CONSTRAINT_UNIQUE / _PRIMARYKEY, or the primary code when extended codes are off
+        const QString code = error.nativeErrorCode();
+        return code == "2067" || code == "1555"
+               || (code == "19" && error.databaseText().contains("UNIQUE constraint failed"));
+    }
+    bool isConnectionLost(const QSqlError &error) const override
+    {
+        // No server to lose; a file still locked by another process after the busy timeout is
+        // the embedded equivalent of an unresponsive one (SQLITE_BUSY, SQLITE_LOCKED)
+        const QString code = error.nativeErrorCode();
+        return error.type() == QSqlError::ConnectionError || code == "5" || code == "6";
+    }
+    bool isTransient(const QSqlError &) const override { return false; } // Lock waits count as lost, above
+    bool isInterrupted(const QSqlError &error) const override
+    {
+        return error.nativeErrorCode() == "9"; // SQLITE_INTERRUPT
+    }
+
+    bool hasColumn(QSqlDatabase db, const QString &table, const QString &column) const override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT COUNT(*) FROM pragma_table_info(?) WHERE name = ?");
+        query.addBindValue(table);
+        query.addBindValue(column);
+        if (!query.exec() || !query.next()) {
+            qDebug() << "Failed to inspect" << table << "columns:" << query.lastError().text();
+            return false;
+        }
+        return query.value(0).toInt() > 0;
+    }
+
+    bool hasIndex(QSqlDatabase db, const QString &table, const QString &index) const override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND name = ?");
+        query.addBindValue(table);
+        query.addBindValue(index);
+        if (!query.exec() || !query.next()) {
+            qDebug() << "Failed to inspect" << table << "indexes:" << query.lastError().text();
+            return false;
+        }
+        return query.value(0).toInt() > 0;
+    }
+    QStringList plannedIndexes(QSqlDatabase db, const QString &select) const override
+    {
+        // Plan rows read like "SEARCH Sales USING INDEX idx_sales_product (product_id=?)"
+        static const QRegularExpression usingIndex("USING (?:COVERING )?INDEX (\\w+)");
+        QStringList indexes;
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec("EXPLAIN QUERY PLAN " + select)) {
+            qDebug() << "EXPLAIN failed:" << query.lastError().text();
+            return indexes;
+        }
+        const int detailColumn = query.record().indexOf("detail");
+        while (query.next()) {
+            const QRegularExpressionMatch match = usingIndex.match(query.value(detailColumn).toString());
+            if (match.hasMatch()) indexes.append(match.captured(1));
+        }
+        return indexes;
+    }
+
+    bool prepareConnection(QSqlDatabase db) const override
+    {
+        // WAL lets the pool's readers run alongside the till's writes, and a commit is one
+        // append to the log. synchronous=FULL still fsyncs it: a sale the cashier saw complete
+        // must survive a power cut. The rest are per-connection and must be set on every open.
+        static const char *const pragmas[] = {
+            "PRAGMA journal_mode = WAL",
+            "PRAGMA synchronous = FULL",
+            "PRAGMA busy_timeout = 5000",
+            "PRAGMA foreign_keys = ON",
+            "PRAGMA temp_store = MEMORY",
+            "PRAGMA cache_size = -16384", // KiB
+            "PRAGMA mmap_size = 67108864",
+        };
+        QSqlQuery query(db);
+        for (const char *pragma : pragmas) {
+            if (!query.exec(pragma)) {
+                qDebug() << "Failed to configure SQLite connection:" << pragma << query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+    QString connectOptions(int) const override { return QString(); } // busy_timeout above bounds the waits
+    QString connectionIdQuery() const override { return QString(); }
+    QString cancelStatement(qint64) const override { return QString(); }
+};
+}
+
+const SqlDialect *SqlDialect::lookup(const QString &name)
+{
+    static const MySqlDialect mysql;
+    static const SqliteDialect sqlite;
+    const SqlDialect *const dialects[] = {&mysql, &sqlite};
+    for (const SqlDialect *dialect : dialects) {
+        if (name.compare(dialect->name(), Qt::CaseInsensitive) == 0 || name == dialect->driverName()) return dialect;
+    }
+    return nullptr;
+}
+
+const SqlDialect *SqlDialect::forDatabase(const QSqlDatabase &db)
+{
+    const SqlDialect *dialect = lookup(db.driverName());
+    return dialect ? dialect : lookup("mysql");
+}
+
+QStringList SqlDialect::baseSchema() const
+{
+    const QString key = autoIncrementKey();
+    return {
+        "CREATE TABLE IF NOT EXISTS Users ("
+        "user_id " + key + ", "
+        "username VARCHAR(64) NOT NULL UNIQUE, "
+        "password VARCHAR(255) NOT NULL, "
+        "role VARCHAR(32) NOT NULL DEFAULT 'Cashier', "
+        "last_logout DATETIME NULL)",
+
+        "CREATE TABLE IF NOT EXISTS Products ("
+        "product_id " + key + ", "
+        "product_name VARCHAR(255) NOT NULL, "
+        "price DECIMAL(10,2) NOT NULL, "
+        "category VARCHAR(255), "
+        "quantity INT NOT NULL DEFAULT 0, "
+        "updated_at DATETIME NULL, "
+        "sku VARCHAR(64) NULL UNIQUE)",
+
+        "CREATE TABLE IF NOT EXISTS Sales ("
+        "sales_id " + key + ", "
+        "salesman_id INT NOT NULL, "
+        "product_id INT NOT NULL, "
+        "product_name VARCHAR(255) NOT NULL, "
+        "price DECIMAL(10,2) NOT NULL, "
+        "category VARCHAR(255), "
+        "quantity_sold INT NOT NULL, "
+        "total_price DECIMAL(12,2) NOT NULL, "
+        "sale_date DATETIME NOT NULL " + timestampDefault() + ")",
+
+        "CREATE TABLE IF NOT EXISTS Debtors ("
+        "debtor_id " + key + ", "
+        "name VARCHAR(255) NOT NULL, "
+        "contact_number VARCHAR(32), "
+        "address VARCHAR(255), "
+        "debt_amount DECIMAL(12,2) NOT NULL DEFAULT 0, "
+        "date_incurred DATE)",
+
+        "CREATE TABLE IF NOT EXISTS Vendors ("
+        "vendor_id " + key + ", "
+        "name VARCHAR(255) NOT NULL, "
+        "address VARCHAR(255), "
+        "contact_number VARCHAR(32), "
+        "cash_balance DECIMAL(12,2) NOT NULL DEFAULT 0, "
+        "date_of_supply DATE)",
+
+        "CREATE TABLE IF NOT EXISTS Workers ("
+        "worker_id " + key + ", "
+        "name VARCHAR(255) NOT NULL, "
+        "contact_number VARCHAR(32), "
+        "email VARCHAR(255), "
+        "status VARCHAR(32), "
+        "salary DECIMAL(12,2) NOT NULL DEFAULT 0, "
+        "date_of_joining DATE)",
+    };
+}
@@ -0,0 +1,77 @@
+#ifndef SQLDIALECT_H
+#define SQLDIALECT_H
+
+#include <QString>
+#include <QStringList>
+#include <QSqlDatabase>
+
+class QSqlError;
+
+// The SQL that differs between backends. Managers build their statements from these fragments
+// instead of hardcoding MySQL syntax, so the same code runs against a MySQL server or an embedded
+// SQLite file. Dialects are stateless singletons and safe to use from any thread.
+class SqlDialect
+{
+public:
+    virtual ~SqlDialect() = default;
+
+    // "mysql" / "sqlite" or a Qt driver name; nullptr if unknown
+    static const SqlDialect *lookup(const QString &name);
+    // Dialect of an existing connection, MySQL if its driver is unknown
+    static const SqlDialect *forDatabase(const QSqlDatabase &db);
+
+    virtual QString name() const = 0;
+    virtual QString driverName() const = 0;
+    virtual bool isEmbedded() const = 0; // No server: a local file, one till
+
+    // Expressions
+    virtual QString now() const = 0;
+    virtual QString today() const = 0;
+    virtual QString daysAgo(int days) const = 0; // The server's date `days` days before today
+    virtual QString concat(const QStringList &expressions) const = 0;
+    virtual QString greatest(const QString &a, const QString &b) const = 0;
+    virtual QString nullSafeEquals(const QString &a, const QString &b) const = 0;
+    virtual QString forUpdate() const = 0; // Row-lock suffix for a SELECT inside a transaction
+
+    // UPDATE table alias, joined to source on a condition. Assignment targets are unqualified.
+    virtual QString updateJoin(const QString &table, const QString &alias, const QString &source,
+                               const QString &on, const QString &assignments,
+                               const QString &where = QString()) const = 0;
+    // insert is a single-row INSERT ... VALUES; on a key clash the assignments run instead.
+    // excluded(column) names the value the clashing insert carried.
+    virtual QString upsert(const QString &insert, const QString &key, const QStringList &assignments) const = 0;
+    virtual QString excluded(const QString &column) const = 0;
+    virtual int maxBindValues() const = 0; // Placeholders one statement may carry
+
+    // DDL
+    virtual QString autoIncrementKey() const = 0;
+    virtual QString timestampDefault() const = 0;
+    QStringList baseSchema() const; // Core tables, for databases this application creates itself
+
+    // Errors
+    virtual bool isDuplicateKey(const QSqlError &error) const = 0;
+    virtual bool isConnectionLost(const QSqlError &error) const = 0;
+    // The statement lost to another transaction (deadlock, lock wait); the same work may succeed later
+    virtual bool isTransient(const QSqlError &error) const = 0;
+    // The running statement was stopped from outside, e.g. by cancelStatement()
+    virtual bool isInterrupted(const QSqlError &error) const = 0;
+
+    // Catalog and session
+    virtual bool hasColumn(QSqlDatabase db, const QString &table, const QString &column) const = 0;
+    virtual bool hasIndex(QSqlDatabase db, const QString &table, const QString &index) const = 0;
+    // Indexes the planner picks for a SELECT, from EXPLAIN
+    virtual QStringList plannedIndexes(QSqlDatabase db, const QString &select) const = 0;
+    virtual bool prepareConnection(QSqlDatabase db) const = 0; // Run right after every open()
+    // Driver options set before open(): connecting and each read or write give up after
+    // timeoutSecs. Empty if the driver has no such options.
+    virtual QString connectOptions(int timeoutSecs) const = 0;
+    virtual QString connectionIdQuery() const = 0;              // Empty if the backend has none
+    virtual QString cancelStatement(qint64 connectionId) const = 0; // Empty if a running query can't be stopped
+
+    // The till's own connection fails fast, so a sale on a dead or half-open link is journaled
+    // instead of freezing the window; pooled and worker connections also run long reports.
+    static constexpr int kInteractiveTimeoutSecs = 2;
+    static constexpr int kBackgroundTimeoutSecs = 120;
+};
+
+#endif // SQLDIALECT_H
@@ -0,0 +1,85 @@
+#include "statementcache.h"
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QDebug>
+
+StatementCache::StatementCache(int maxPerConnection)
+    : m_maxPerConnection(qMax(1, maxPerConnection))
+    , m_hits(0)
+    , m_misses(0)
+    , m_useClock(0)
+{
+}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+CachedQuery StatementCache::acquire(const QSqlDatabase &db, const QString &sql)
+{
+    const QString connectionName = db.connectionName();
+    {
+        QMutexLocker locker(&m_mutex);
+        auto connection = m_connections.find(connectionName);
+        if (connection != m_connections.end()) {
+            auto statement = connection->find(sql);
+            if (statement != connection->end()) {
+                ++m_hits;
+                statement->lastUse = ++m_useClock;
+                CachedQuery query = statement->query;
+                query->finish(); // Release the previous result set before re-binding
+                return query;
+            }
+        }
+    }
+
+    ++m_misses;
+    auto query = std::make_shared<QSqlQuery>(db);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        qDebug() << "Failed to prepare statement:" << query->lastError().text();
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Statements &statements = m_connections[connectionName];
+    if (statements.size() >= m_maxPerConnection) evictOne(statements);
+    statements.insert(sql, {query, ++m_useClock});
+    return query;
+}
+
+void StatementCache::evictOne(Statements &statements)
+{
+    // Least recently used, preferring one no caller holds; a held one lives on with its holder
+    auto victim = statements.end();
+    for (auto it = statements.begin(); it != statements.end(); ++it) {
+        const bool held = it->query.use_count() > 1;
+        if (victim == statements.end()) {
+            victim = it;
+            continue;
+        }
+        const bool victimHeld = victim->query.use_count() > 1;
+        if (held != victimHeld ? !held : it->lastUse < victim->lastUse) victim = it;
+    }
+    if (victim != statements.end()) statements.erase(victim);
+}
+
+void StatementCache::invalidate(const QString &connectionName)
+{
+    Statements dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        dropped = m_connections.take(connectionName);
+    }
+    // dropped goes out of scope here, finalizing the statements outside the lock
+}
+
+void StatementCache::clear()
+{
+    QHash<QString, Statements> dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        dropped.swap(m_connections);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+
+// Keeps server-side prepared statements alive per connection, keyed by SQL text, so hot paths
+// (search-as-you-type, scanned items) only re-bind values instead of re-parsing the statement.
+// A cached query belongs to its connection's thread and must not be used re-entrantly.
+// Callers share ownership, so a statement evicted or invalidated while held stays valid until released.
+using CachedQuery = std::shared_ptr<QSqlQuery>;
+
+class StatementCache
+{
+public:
+    explicit StatementCache(int maxPerConnection = 64);
+    ~StatementCache();
+
+    // Returns a query prepared on db for sql, or nullptr if preparation failed
+    CachedQuery acquire(const QSqlDatabase &db, const QString &sql);
+
+    // Drops every statement prepared on the connection; call before reconnecting or removing it
+    void invalidate(const QString &connectionName);
+    void clear();
+
+    quint64 hits() const { return m_hits.load(); }
+    quint64 misses() const { return m_misses.load(); }
+
+private:
+    struct Entry {
+        CachedQuery query;
+        quint64 lastUse;
+    };
+    using Statements = QHash<QString, Entry>;
+
+    static void evictOne(Statements &statements);
+
+    int m_maxPerConnection;
+    mutable QMutex m_mutex;
+    QHash<QString, Statements> m_connections;
+    std::atomic<quint64> m_hits;
+    std::atomic<quint64> m_misses;
+    quint64 m_useClock; // Guarded by m_mutex
+};
+
+#endif // STATEMENTCACHE_H
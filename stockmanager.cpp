@@ -2,92 +2,106 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
-#include <QTableWidgetItem>
 
 StockManager::StockManager(DatabaseHandler *dbHandler, QObject *parent)
     : QObject(parent)
     , m_dbHandler(dbHandler)
+    , m_loader(new ModelLoader(dbHandler, "stock", this))
 {
 }
 
-bool StockManager::loadStock(QTableWidget *tableWidget)
+RowBufferModel *StockManager::createModel(const QStringList &headers, QObject *parent)
 {
-    if (!m_dbHandler->isConnected()) {
-        qDebug() << "Database not connected";
-        return false;
-    }
+    return new RowBufferModel(RowBufferModel::describe(headers, {
+        RowBufferModel::Integer, RowBufferModel::Text, RowBufferModel::Real,
+        RowBufferModel::Text, RowBufferModel::Integer, RowBufferModel::Integer}), parent);
+}
 
-    tableWidget->setRowCount(0);
+bool StockManager::loadStock(RowBufferModel *model)
+{
+    return m_loader->submit(model,
+                            "SELECT product_id, product_name, price, category, quantity as total_quantity, "
+                            "quantity - sold_quantity as remaining_quantity "
+                            "FROM ProductStock ORDER BY product_id",
+                            {}, DatabaseWorker::Background) != 0;
+}
 
-    QSqlQuery query;
-    query.prepare("SELECT p.product_id, p.product_name, p.price, p.category, "
-                  "SUM(p.quantity) as total_quantity, "
-                  "COALESCE(SUM(p.quantity) - COALESCE(s.sold_quantity, 0), SUM(p.quantity)) as remaining_quantity "
-                  "FROM Products p "
-                  "LEFT JOIN (SELECT product_id, SUM(quantity_sold) as sold_quantity FROM Sales GROUP BY product_id) s "
-                  "ON p.product_id = s.product_id "
-                  "GROUP BY p.product_id, p.product_name, p.price, p.category "
-                  "ORDER BY p.product_name");
+quint64 StockManager::searchStock(RowBufferModel *model, const QString &searchText)
+{
+    const QString pattern = "%" + searchText + "%";
+    return m_loader->submit(model,
+                            "SELECT product_id, product_name, price, category, quantity as total_quantity, "
+                            "quantity - sold_quantity as remaining_quantity "
+                            "FROM ProductStock WHERE product_name LIKE ? OR category LIKE ? "
+                            "ORDER BY product_id",
+                            {pattern, pattern}, DatabaseWorker::Interactive);
+}
 
-    if (!query.exec()) {
-        qDebug() << "Failed to load stock:" << query.lastError().text();
+bool StockManager::ensureStockSummary()
+{
+    if (!m_dbHandler->isConnected()) return false;
+
+    // The schema migrations create the table. A fresh (or wiped) summary is seeded once;
+    // afterwards it is maintained incrementally.
+    QSqlQuery query;
+    if (!query.exec("SELECT EXISTS(SELECT 1 FROM ProductStock), EXISTS(SELECT 1 FROM Products)") || !query.next()) {
+        qDebug() << "Failed to inspect stock summary:" << query.lastError().text();
         return false;
     }
+    if (!query.value(0).toBool() && query.value(1).toBool()) return rebuildStockSummary();
+    return true;
+}
 
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
+bool StockManager::rebuildStockSummary()
+{
+    if (!m_dbHandler->isConnected()) return false;
 
-        tableWidget->setItem(row, 0, new QTableWidgetItem(query.value("product_id").toString()));
-        tableWidget->setItem(row, 1, new QTableWidgetItem(query.value("product_name").toString()));
-        tableWidget->setItem(row, 2, new QTableWidgetItem(query.value("price").toString()));
-        tableWidget->setItem(row, 3, new QTableWidgetItem(query.value("category").toString()));
-        tableWidget->setItem(row, 4, new QTableWidgetItem(query.value("total_quantity").toString()));
-        tableWidget->setItem(row, 5, new QTableWidgetItem(query.value("remaining_quantity").toString()));
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
 
-        row++;
+    QSqlQuery query;
+    if (!query.exec("DELETE FROM ProductStock")
+        || !query.exec("INSERT INTO ProductStock (product_id, product_name, price, category, quantity, sold_quantity) "
+                       "SELECT p.product_id, p.product_name, p.price, p.category, p.quantity, "
+                       "COALESCE(s.sold_quantity, 0) "
+                       "FROM Products p "
+                       "LEFT JOIN (SELECT product_id, SUM(quantity_sold) as sold_quantity FROM Sales GROUP BY product_id) s "
+                       "ON p.product_id = s.product_id")) {
+        qDebug() << "Failed to rebuild stock summary:" << query.lastError().text();
+        db.rollback();
+        return false;
     }
 
+    db.commit();
+    emit stockUpdated();
     return true;
 }
 
-void StockManager::searchStock(QTableWidget *tableWidget, const QString &searchText)
+int StockManager::verifyStockSummary()
 {
-    if (!m_dbHandler->isConnected()) {
-        qDebug() << "Database not connected";
-        return;
-    }
-
-    tableWidget->setRowCount(0);
+    if (!m_dbHandler->isConnected()) return -1;
 
+    // Rows missing from or differing in the summary, plus summary rows whose product is gone
     QSqlQuery query;
-    query.prepare("SELECT p.product_id, p.product_name, p.price, p.category, "
-                  "SUM(p.quantity) as total_quantity, "
-                  "COALESCE(SUM(p.quantity) - COALESCE(s.sold_quantity, 0), SUM(p.quantity)) as remaining_quantity "
-                  "FROM Products p "
-                  "LEFT JOIN (SELECT product_id, SUM(quantity_sold) as sold_quantity FROM Sales GROUP BY product_id) s "
-                  "ON p.product_id = s.product_id "
-                  "WHERE p.product_name LIKE :search OR p.category LIKE :search "
-                  "GROUP BY p.product_id, p.product_name, p.price, p.category "
-                  "ORDER BY p.product_name");
-    query.bindValue(":search", "%" + searchText + "%");
-
-    if (!query.exec()) {
-        qDebug() << "Failed to search stock:" << query.lastError().text();
-        return;
+    query.setForwardOnly(true);
+    const QString sameCategory = m_dbHandler->dialect()->nullSafeEquals("ps.category", "p.category");
+    if (!query.exec("SELECT "
+                    "(SELECT COUNT(*) FROM Products p "
+                    " LEFT JOIN ProductStock ps ON ps.product_id = p.product_id "
+                    " LEFT JOIN (SELECT product_id, SUM(quantity_sold) as sold_quantity FROM Sales GROUP BY product_id) s "
+                    " ON s.product_id = p.product_id "
+                    " WHERE ps.product_id IS NULL OR ps.quantity <> p.quantity "
+                    " OR ps.sold_quantity <> COALESCE(s.sold_quantity, 0) "
+                    " OR ps.product_name <> p.product_name OR ps.price <> p.price "
+                    " OR NOT (" + sameCategory + ")) + "
+                    "(SELECT COUNT(*) FROM ProductStock ps "
+                    " LEFT JOIN Products p ON p.product_id = ps.product_id WHERE p.product_id IS NULL)")
+        || !query.next()) {
+        qDebug() << "Failed to verify stock summary:" << query.lastError().text();
+        return -1;
     }
 
-    int row = 0;
-    while (query.next()) {
-        tableWidget->insertRow(row);
-
-        tableWidget->setItem(row, 0, new QTableWidgetItem(query.value("product_id").toString()));
-        tableWidget->setItem(row, 1, new QTableWidgetItem(query.value("product_name").toString()));
-        tableWidget->setItem(row, 2, new QTableWidgetItem(query.value("price").toString()));
-        tableWidget->setItem(row, 3, new QTableWidgetItem(query.value("category").toString()));
-        tableWidget->setItem(row, 4, new QTableWidgetItem(query.value("total_quantity").toString()));
-        tableWidget->setItem(row, 5, new QTableWidgetItem(query.value("remaining_quantity").toString()));
-
-        row++;
-    }
+    const int mismatches = query.value(0).toInt();
+    if (mismatches > 0) qDebug() << "Stock summary has" << mismatches << "mismatched rows";
+    return mismatches;
 }
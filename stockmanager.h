@@ -2,8 +2,9 @@
 #define STOCKMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
 #include "databasehandler.h"
+#include "rowbuffermodel.h"
+#include "modelloader.h"
 
 class StockManager : public QObject
 {
@@ -12,14 +13,24 @@ class StockManager : public QObject
 public:
     explicit StockManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
 
-    bool loadStock(QTableWidget *tableWidget);
-    void searchStock(QTableWidget *tableWidget, const QString &searchText);
+    // Model whose columns match the stock SELECTs below
+    static RowBufferModel *createModel(const QStringList &headers, QObject *parent = nullptr);
+
+    bool loadStock(RowBufferModel *model);
+    quint64 searchStock(RowBufferModel *model, const QString &searchText); // Worker request id
+
+    // ProductStock summary maintenance. The table is kept current by product add/remove and
+    // processSale; these rebuild it from Products/Sales or report how many rows have drifted.
+    bool ensureStockSummary();
+    bool rebuildStockSummary();
+    int verifyStockSummary(); // Mismatched rows, or -1 on error
 
 signals:
     void stockUpdated();
 
 private:
     DatabaseHandler *m_dbHandler;
+    ModelLoader *m_loader;
 };
 
 #endif // STOCKMANAGER_H
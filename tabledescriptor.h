@@ -0,0 +1,186 @@
+#ifndef TABLEDESCRIPTOR_H
+#define TABLEDESCRIPTOR_H
+
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include "rowbuffermodel.h"
+
+// An entity table described once, at compile time: the SELECT and INSERT text, the model's
+// column types and its typed row decoder are all generated from it, so they can't drift apart. A
+// descriptor is a struct with
+//
+//     static constexpr const char *kName = "Debtors";
+//     enum Column { Id, Name, ..., ColumnCount };      // kColumns order; Id is the key
+//     static constexpr TableColumn kColumns[] = {{"debtor_id", RowBufferModel::Integer}, ...};
+//
+// Column indexes are enum values checked against kColumns by static_assert; views use the same
+// enum (e.g. DebtorsTable::Name) instead of bare column numbers.
+struct TableColumn {
+    const char *name;
+    RowBufferModel::ColumnType type;
+};
+
+namespace tablesql {
+constexpr std::size_t length(const char *text)
+{
+    std::size_t n = 0;
+    while (text[n]) ++n;
+    return n;
+}
+
+constexpr bool equal(const char *a, const char *b)
+{
+    while (*a && *a == *b) ++a, ++b;
+    return *a == *b;
+}
+
+template <std::size_t N>
+constexpr std::size_t put(std::array<char, N> &out, std::size_t pos, const char *text)
+{
+    while (*text) out[pos++] = *text++;
+    return pos;
+}
+
+template <typename Table>
+constexpr int columnCount() { return int(std::size(Table::kColumns)); }
+
+template <typename Table>
+constexpr bool namesUnique()
+{
+    for (int i = 0; i < columnCount<Table>(); ++i) {
+        if (length(Table::kColumns[i].name) == 0) return false;
+        for (int j = i + 1; j < columnCount<Table>(); ++j) {
+            if (equal(Table::kColumns[i].name, Table::kColumns[j].name)) return false;
+        }
+    }
+    return true;
+}
+
+// "a, b, c" over kColumns[first..]
+template <typename Table>
+constexpr std::size_t listLength(int first)
+{
+    std::size_t n = 0;
+    for (int i = first; i < columnCount<Table>(); ++i) n += length(Table::kColumns[i].name) + (i > first ? 2 : 0);
+    return n;
+}
+
+template <typename Table, std::size_t N>
+constexpr std::size_t putList(std::array<char, N> &out, std::size_t pos, int first)
+{
+    for (int i = first; i < columnCount<Table>(); ++i) {
+        if (i > first) pos = put(out, pos, ", ");
+        pos = put(out, pos, Table::kColumns[i].name);
+    }
+    return pos;
+}
+
+template <typename Table>
+constexpr std::size_t selectLength()
+{
+    return length("SELECT ") + listLength<Table>(0) + length(" FROM ") + length(Table::kName);
+}
+
+template <typename Table>
+constexpr std::array<char, selectLength<Table>() + 1> selectText()
+{
+    std::array<char, selectLength<Table>() + 1> out{};
+    std::size_t pos = put(out, 0, "SELECT ");
+    pos = putList<Table>(out, pos, 0);
+    pos = put(out, pos, " FROM ");
+    put(out, pos, Table::kName);
+    return out;
+}
+
+// The key is left to the database
+template <typename Table>
+constexpr std::size_t insertLength()
+{
+    return length("INSERT INTO ") + length(Table::kName) + length(" (") + listLength<Table>(1)
+           + length(") VALUES (") + 3 * std::size_t(columnCount<Table>() - 1) - 2 + length(")");
+}
+
+template <typename Table>
+constexpr std::array<char, insertLength<Table>() + 1> insertText()
+{
+    std::array<char, insertLength<Table>() + 1> out{};
+    std::size_t pos = put(out, 0, "INSERT INTO ");
+    pos = put(out, pos, Table::kName);
+    pos = put(out, pos, " (");
+    pos = putList<Table>(out, pos, 1);
+    pos = put(out, pos, ") VALUES (");
+    for (int i = 1; i < columnCount<Table>(); ++i) pos = put(out, pos, i > 1 ? ", ?" : "?");
+    put(out, pos, ")");
+    return out;
+}
+}
+
+template <typename Table>
+class TableSql
+{
+public:
+    static constexpr int kColumnCount = tablesql::columnCount<Table>();
+
+private:
+    static_assert(kColumnCount == Table::ColumnCount, "Column enum and kColumns disagree");
+    static_assert(kColumnCount >= 2, "A table needs a key and at least one value column");
+    static_assert(Table::kColumns[0].type == RowBufferModel::Integer, "Column 0 must be the integer key");
+    static_assert(tablesql::namesUnique<Table>(), "Column names must be non-empty and unique");
+
+    // Built by the compiler; only the QString wrapping happens at run time
+    static constexpr auto kSelect = tablesql::selectText<Table>();
+    static constexpr auto kInsert = tablesql::insertText<Table>();
+
+public:
+    // "SELECT <every column> FROM <table>", for the caller to add WHERE / ORDER BY
+    static QString select() { return QString::fromLatin1(kSelect.data(), int(kSelect.size() - 1)); }
+    // "INSERT INTO <table> (<every column but the key>) VALUES (?, ...)", bound in kColumns order
+    static QString insert() { return QString::fromLatin1(kInsert.data(), int(kInsert.size() - 1)); }
+
+    static constexpr const char *name(int column) { return Table::kColumns[column].name; }
+
+    template <int Column>
+    static constexpr RowBufferModel::ColumnType type()
+    {
+        static_assert(Column >= 0 && Column < kColumnCount, "Column index out of range");
+        return Table::kColumns[Column].type;
+    }
+
+    static QVector<RowBufferModel::Column> modelColumns(const QStringList &headers)
+    {
+        QVector<RowBufferModel::Column> columns;
+        columns.reserve(kColumnCount);
+        for (int i = 0; i < kColumnCount; ++i) columns.append({headers.value(i), Table::kColumns[i].type});
+        return columns;
+    }
+};
+
+// RowBufferModel laid out as TableSql<Table>::select(). Rows from the worker are appended with
+// the column types fixed at compile time: no per-cell type switch, one call per row.
+template <typename Table>
+class TableModel : public RowBufferModel
+{
+public:
+    explicit TableModel(const QStringList &headers, QObject *parent = nullptr)
+        : RowBufferModel(TableSql<Table>::modelColumns(headers), parent) {}
+
+protected:
+    void appendRow(const QVariantList &values) override
+    {
+        appendCells(values, std::make_integer_sequence<int, TableSql<Table>::kColumnCount>());
+        ++m_rowCount;
+    }
+
+private:
+    template <int... Column>
+    void appendCells(const QVariantList &values, std::integer_sequence<int, Column...>)
+    {
+        (appendCell<Table::kColumns[Column].type>(Column, values.value(Column)), ...);
+    }
+};
+
+#endif // TABLEDESCRIPTOR_H
@@ -0,0 +1,64 @@
+#ifndef TABLES_H
+#define TABLES_H
+
+#include "tabledescriptor.h"
+
+// Column layouts of the entity lists. Each manager's SELECT, INSERT and model come from these,
+// so adding or reordering a column here is the whole change.
+
+struct ProductsTable {
+    static constexpr const char *kName = "Products";
+    enum Column { Id, Name, Price, Category, Quantity, UpdatedAt, ColumnCount };
+    // updated_at is a datetime but only the date is shown, so the model column is typed Date.
+    // sku is written separately (NULL when empty) and isn't part of the list.
+    static constexpr TableColumn kColumns[] = {
+        {"product_id", RowBufferModel::Integer},
+        {"product_name", RowBufferModel::Text},
+        {"price", RowBufferModel::Real},
+        {"category", RowBufferModel::Text},
+        {"quantity", RowBufferModel::Integer},
+        {"updated_at", RowBufferModel::Date},
+    };
+};
+
+struct DebtorsTable {
+    static constexpr const char *kName = "Debtors";
+    enum Column { Id, Name, Contact, Address, Amount, Incurred, ColumnCount };
+    static constexpr TableColumn kColumns[] = {
+        {"debtor_id", RowBufferModel::Integer},
+        {"name", RowBufferModel::Text},
+        {"contact_number", RowBufferModel::Text},
+        {"address", RowBufferModel::Text},
+        {"debt_amount", RowBufferModel::Real},
+        {"date_incurred", RowBufferModel::Date},
+    };
+};
+
+struct VendorsTable {
+    static constexpr const char *kName = "Vendors";
+    enum Column { Id, Name, Contact, Address, CashBalance, SupplyDate, ColumnCount };
+    static constexpr TableColumn kColumns[] = {
+        {"vendor_id", RowBufferModel::Integer},
+        {"name", RowBufferModel::Text},
+        {"contact_number", RowBufferModel::Text},
+        {"address", RowBufferModel::Text},
+        {"cash_balance", RowBufferModel::Real},
+        {"date_of_supply", RowBufferModel::Date},
+    };
+};
+
+struct WorkersTable {
+    static constexpr const char *kName = "Workers";
+    enum Column { Id, Name, Contact, Email, Status, Salary, JoinDate, ColumnCount };
+    static constexpr TableColumn kColumns[] = {
+        {"worker_id", RowBufferModel::Integer},
+        {"name", RowBufferModel::Text},
+        {"contact_number", RowBufferModel::Text},
+        {"email", RowBufferModel::Text},
+        {"status", RowBufferModel::Text},
+        {"salary", RowBufferModel::Real},
+        {"date_of_joining", RowBufferModel::Date},
+    };
+};
+
+#endif // TABLES_H
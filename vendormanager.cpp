@@ -4,24 +4,26 @@
 #include <QDebug>
 
 VendorManager::VendorManager(DatabaseHandler *dbHandler, QObject *parent)
-    : QObject(parent), m_dbHandler(dbHandler) {}
+    : QObject(parent), m_dbHandler(dbHandler), m_loader(new ModelLoader(dbHandler, "vendors", this)) {}
 
-bool VendorManager::loadVendors(QTableWidget *tableWidget)
+RowBufferModel *VendorManager::createModel(const QStringList &headers, QObject *parent)
 {
-    return populateTable(tableWidget,
-                         "SELECT vendor_id, name, contact_number, address, cash_balance, date_of_supply "
-                         "FROM Vendors ORDER BY name");
+    return new TableModel<VendorsTable>(headers, parent);
 }
 
-void VendorManager::searchVendors(QTableWidget *tableWidget, const QString &searchText)
+bool VendorManager::loadVendors(RowBufferModel *model)
 {
-    QSqlQuery query;
-    query.prepare("SELECT vendor_id, name, contact_number, address, cash_balance, date_of_supply "
-                  "FROM Vendors WHERE name LIKE :search OR address LIKE :search "
-                  "OR contact_number LIKE :search ORDER BY name");
-    query.bindValue(":search", "%" + searchText + "%");
+    return m_loader->submit(model, TableSql<VendorsTable>::select() + " ORDER BY name",
+                            {}, DatabaseWorker::Background) != 0;
+}
 
-    populateTableWithQuery(tableWidget, query);
+quint64 VendorManager::searchVendors(RowBufferModel *model, const QString &searchText)
+{
+    const QString pattern = "%" + searchText + "%";
+    return m_loader->submit(model,
+                            TableSql<VendorsTable>::select() + " WHERE name LIKE ? OR address LIKE ? "
+                            "OR contact_number LIKE ? ORDER BY name",
+                            {pattern, pattern, pattern}, DatabaseWorker::Interactive);
 }
 
 bool VendorManager::addVendor(const QString &name, const QString &address, const QString &contact,
@@ -30,13 +32,12 @@ bool VendorManager::addVendor(const QString &name, const QString &address, const
     if (!m_dbHandler->isConnected()) return false;
 
     QSqlQuery query;
-    query.prepare("INSERT INTO Vendors (name, address, contact_number, cash_balance, date_of_supply) "
-                  "VALUES (:name, :address, :contact, :cash, :date)");
-    query.bindValue(":name", name);
-    query.bindValue(":address", address);
-    query.bindValue(":contact", contact);
-    query.bindValue(":cash", cashBalance);
-    query.bindValue(":date", dateOfSupply);
+    query.prepare(TableSql<VendorsTable>::insert());
+    query.addBindValue(name);
+    query.addBindValue(contact);
+    query.addBindValue(address);
+    query.addBindValue(cashBalance);
+    query.addBindValue(dateOfSupply);
 
     if (query.exec()) {
         emit vendorsUpdated();
@@ -52,37 +53,6 @@ bool VendorManager::removeVendor(int vendorId)
     return executeUpdate("DELETE FROM Vendors WHERE vendor_id = ?", {vendorId});
 }
 
-// Private helper methods
-bool VendorManager::populateTable(QTableWidget *table, const QString &queryStr)
-{
-    QSqlQuery query;
-    query.prepare(queryStr);
-    return populateTableWithQuery(table, query);
-}
-
-bool VendorManager::populateTableWithQuery(QTableWidget *table, QSqlQuery &query)
-{
-    if (!m_dbHandler->isConnected() || !query.exec()) {
-        qDebug() << "Query failed:" << query.lastError().text();
-        return false;
-    }
-
-    table->setRowCount(0);
-    const QStringList columns = {"vendor_id", "name", "contact_number", "address", "cash_balance", "date_of_supply"};
-    const int dateColumn = 5;
-
-    for (int row = 0; query.next(); ++row) {
-        table->insertRow(row);
-        for (int col = 0; col < columns.size(); ++col) {
-            QString value = (col == dateColumn) ?
-                                query.value(columns[col]).toDate().toString("yyyy-MM-dd") :
-                                query.value(columns[col]).toString();
-            table->setItem(row, col, new QTableWidgetItem(value));
-        }
-    }
-    return true;
-}
-
 bool VendorManager::executeUpdate(const QString &queryStr, const QVariantList &params)
 {
     if (!m_dbHandler->isConnected()) return false;
@@ -2,10 +2,12 @@
 #define VENDORMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
 #include <QDate>
 #include <QVariantList>
 #include "databasehandler.h"
+#include "rowbuffermodel.h"
+#include "modelloader.h"
+#include "tables.h"
 
 class VendorManager : public QObject
 {
@@ -13,8 +15,11 @@ class VendorManager : public QObject
 public:
     explicit VendorManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
 
-    bool loadVendors(QTableWidget *tableWidget);
-    void searchVendors(QTableWidget *tableWidget, const QString &searchText);
+    // Model laid out as VendorsTable, like every vendor SELECT below
+    static RowBufferModel *createModel(const QStringList &headers, QObject *parent = nullptr);
+
+    bool loadVendors(RowBufferModel *model);
+    quint64 searchVendors(RowBufferModel *model, const QString &searchText); // Worker request id
     bool addVendor(const QString &name, const QString &address, const QString &contact,
                    double cashBalance, const QDate &dateOfSupply);
     bool removeVendor(int vendorId);
@@ -24,10 +29,9 @@ signals:
 
 private:
     DatabaseHandler *m_dbHandler;
+    ModelLoader *m_loader;
 
     // Helper methods to reduce code duplication
-    bool populateTable(QTableWidget *table, const QString &queryStr);
-    bool populateTableWithQuery(QTableWidget *table, QSqlQuery &query);
     bool executeUpdate(const QString &queryStr, const QVariantList &params = {});
 };
 
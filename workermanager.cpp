@@ -4,24 +4,26 @@
 #include <QDebug>
 
 WorkerManager::WorkerManager(DatabaseHandler *dbHandler, QObject *parent)
-    : QObject(parent), m_dbHandler(dbHandler) {}
+    : QObject(parent), m_dbHandler(dbHandler), m_loader(new ModelLoader(dbHandler, "workers", this)) {}
 
-bool WorkerManager::loadWorkers(QTableWidget *tableWidget)
+RowBufferModel *WorkerManager::createModel(const QStringList &headers, QObject *parent)
 {
-    return populateTable(tableWidget,
-                         "SELECT worker_id, name, contact_number, email, status, salary, date_of_joining "
-                         "FROM Workers ORDER BY name");
+    return new TableModel<WorkersTable>(headers, parent);
 }
 
-void WorkerManager::searchWorkers(QTableWidget *tableWidget, const QString &searchText)
+bool WorkerManager::loadWorkers(RowBufferModel *model)
 {
-    QSqlQuery query;
-    query.prepare("SELECT worker_id, name, contact_number, email, status, salary, date_of_joining "
-                  "FROM Workers WHERE name LIKE :search OR contact_number LIKE :search "
-                  "OR email LIKE :search ORDER BY name");
-    query.bindValue(":search", "%" + searchText + "%");
+    return m_loader->submit(model, TableSql<WorkersTable>::select() + " ORDER BY name",
+                            {}, DatabaseWorker::Background) != 0;
+}
 
-    populateTableWithQuery(tableWidget, query);
+quint64 WorkerManager::searchWorkers(RowBufferModel *model, const QString &searchText)
+{
+    const QString pattern = "%" + searchText + "%";
+    return m_loader->submit(model,
+                            TableSql<WorkersTable>::select() + " WHERE name LIKE ? OR contact_number LIKE ? "
+                            "OR email LIKE ? ORDER BY name",
+                            {pattern, pattern, pattern}, DatabaseWorker::Interactive);
 }
 
 bool WorkerManager::addWorker(const QString &name, const QString &contact, const QString &email,
@@ -30,14 +32,13 @@ bool WorkerManager::addWorker(const QString &name, const QString &contact, const
     if (!m_dbHandler->isConnected()) return false;
 
     QSqlQuery query;
-    query.prepare("INSERT INTO Workers (name, contact_number, email, status, salary, date_of_joining) "
-                  "VALUES (:name, :contact, :email, :status, :salary, :date)");
-    query.bindValue(":name", name);
-    query.bindValue(":contact", contact);
-    query.bindValue(":email", email);
-    query.bindValue(":status", status);
-    query.bindValue(":salary", salary);
-    query.bindValue(":date", dateOfJoining);
+    query.prepare(TableSql<WorkersTable>::insert());
+    query.addBindValue(name);
+    query.addBindValue(contact);
+    query.addBindValue(email);
+    query.addBindValue(status);
+    query.addBindValue(salary);
+    query.addBindValue(dateOfJoining);
 
     if (query.exec()) {
         emit workersUpdated();
@@ -53,37 +54,6 @@ bool WorkerManager::removeWorker(int workerId)
     return executeUpdate("DELETE FROM Workers WHERE worker_id = ?", {workerId});
 }
 
-// Private helper methods
-bool WorkerManager::populateTable(QTableWidget *table, const QString &queryStr)
-{
-    QSqlQuery query;
-    query.prepare(queryStr);
-    return populateTableWithQuery(table, query);
-}
-
-bool WorkerManager::populateTableWithQuery(QTableWidget *table, QSqlQuery &query)
-{
-    if (!m_dbHandler->isConnected() || !query.exec()) {
-        qDebug() << "Query failed:" << query.lastError().text();
-        return false;
-    }
-
-    table->setRowCount(0);
-    const QStringList columns = {"worker_id", "name", "contact_number", "email", "status", "salary", "date_of_joining"};
-    const int dateColumn = 6;
-
-    for (int row = 0; query.next(); ++row) {
-        table->insertRow(row);
-        for (int col = 0; col < columns.size(); ++col) {
-            QString value = (col == dateColumn) ?
-                                query.value(columns[col]).toDate().toString("yyyy-MM-dd") :
-                                query.value(columns[col]).toString();
-            table->setItem(row, col, new QTableWidgetItem(value));
-        }
-    }
-    return true;
-}
-
 bool WorkerManager::executeUpdate(const QString &queryStr, const QVariantList &params)
 {
     if (!m_dbHandler->isConnected()) return false;
@@ -2,9 +2,11 @@
 #define WORKERMANAGER_H
 
 #include <QObject>
-#include <QTableWidget>
 #include <QDate>
 #include "databasehandler.h"
+#include "rowbuffermodel.h"
+#include "modelloader.h"
+#include "tables.h"
 
 class WorkerManager : public QObject
 {
@@ -12,11 +14,14 @@ class WorkerManager : public QObject
 public:
     explicit WorkerManager(DatabaseHandler *dbHandler, QObject *parent = nullptr);
 
-    // Load all workers to the table widget
-    bool loadWorkers(QTableWidget *tableWidget);
+    // Model laid out as WorkersTable, like every worker SELECT below
+    static RowBufferModel *createModel(const QStringList &headers, QObject *parent = nullptr);
+
+    // Load all workers into the model
+    bool loadWorkers(RowBufferModel *model);
 
     // Search workers by name or contact number
-    void searchWorkers(QTableWidget *tableWidget, const QString &searchText);
+    quint64 searchWorkers(RowBufferModel *model, const QString &searchText); // Worker request id
 
     // Add a new worker
     bool addWorker(const QString &name, const QString &contact, const QString &email,
@@ -26,14 +31,13 @@ public:
     bool removeWorker(int workerId);
 
     bool executeUpdate(const QString &queryStr, const QVariantList &params);
-    bool populateTable(QTableWidget *table, const QString &queryStr);
-    bool populateTableWithQuery(QTableWidget *table, QSqlQuery &query);
 
 signals:
     void workersUpdated();
 
 private:
     DatabaseHandler *m_dbHandler;
+    ModelLoader *m_loader;
 };
 
 #endif // WORKERMANAGER_H